@@ -0,0 +1,134 @@
+#include "agent_Evaluation.hpp"
+
+#include <algorithm>
+
+#include "engine_GameState.hpp"
+#include "engine_Move.hpp"
+#include "engine_MoveList.hpp"
+
+namespace agent {
+
+/* Points a discount, a point on a reserved card and a fully paid noble are
+ * worth before they are scored. Progress on a noble counts quadratically:
+ * the last missing discounts are the ones that bring it in. */
+static float constexpr kDiscountWeight = 1.0f;
+static float constexpr kReservedPointWeight = 0.5f;
+static float constexpr kNobleWeight = 2.0f;
+/* Leads below this many points are too close to call. */
+static float constexpr kDrawMargin = 1.0f;
+
+/* Move priors, purchases above collects above face up reserves above blind
+ * ones whatever the points or gems involved. */
+static uint32 constexpr kPurchasePrior = 3000u;
+static uint32 constexpr kCollectPrior = 2000u;
+static uint32 constexpr kReservePrior = 1000u;
+
+/* A turn scores at most one card and one noble. */
+static std::size_t constexpr kMaxTurnPointCount = 5u + 3u;
+
+float Evaluate(engine::GameState const& aState, uint8 aPlayer) {
+  auto const& player = aState.GetPlayers()[aPlayer];
+  auto const& discount = player.GetDiscount();
+
+  float value = player.GetPoints() + kDiscountWeight * discount.GetCount();
+
+  for (auto const& card : player.GetReservedDevelopmentCards()) {
+    if (card && !card.IsHidden()) {
+      value += kReservedPointWeight * card.GetPoints();
+    }
+  }
+
+  for (auto const& noble : aState.GetNobles()) {
+    if (!noble) {
+      continue;
+    }
+    float cost = noble.GetCost().GetCount();
+    float missing =
+        engine::Gemset::ApplyDiscount(noble.GetCost(), discount).GetCount();
+    float progress = (cost - missing) / cost;
+    value += kNobleWeight * noble.GetPoints() * progress * progress;
+  }
+  return value;
+}
+
+std::optional<uint8> GetLockedWinner(engine::GameState const& aState) {
+  auto const& players = aState.GetPlayers();
+  std::size_t left = players.front().GetPoints();
+  std::size_t right = players.back().GetPoints();
+
+  // Once someone reaches the winning points the round ends the game, and
+  // nobody has more than one turn left in it.
+  if (std::max(left, right) < engine::GameState::kWinningPointCount) {
+    return std::nullopt;
+  }
+  if (left > right + kMaxTurnPointCount) {
+    return 0u;
+  }
+  if (right > left + kMaxTurnPointCount) {
+    return 1u;
+  }
+  return std::nullopt;
+}
+
+std::optional<uint8> EstimateWinner(engine::GameState const& aState) {
+  if (auto locked = GetLockedWinner(aState)) {
+    return locked;
+  }
+
+  float lead = Evaluate(aState, 0u) - Evaluate(aState, 1u);
+  if (lead >= kDrawMargin) {
+    return 0u;
+  }
+  if (lead <= -kDrawMargin) {
+    return 1u;
+  }
+  return std::nullopt;
+}
+
+void OrderMoves(engine::GameState const& aState, engine::MoveList& aMoves) {
+  using engine::Gemset;
+  using engine::MoveType;
+
+  auto const& player = aState.GetPlayers()[aState.GetNextPlayer()];
+  auto power = Gemset::Add(player.GetDiscount(), player.GetHeld());
+
+  // The most gems of each color any revealed card still asks for.
+  Gemset lacking{};
+  for (auto const& row : aState.GetRevealedDevelopmentCards()) {
+    for (auto const& card : row) {
+      if (!card) {
+        continue;
+      }
+      auto missing = Gemset::ApplyDiscount(card.GetCost(), power);
+      for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+        lacking.Set(i, std::max(lacking.Get(i), missing.Get(i)));
+      }
+    }
+  }
+
+  auto getPrior = [&](engine::Move const& aMove) -> uint32 {
+    switch (aMove.mType) {
+      case MoveType::kPurchase:
+        return kPurchasePrior + aMove.mPurchase.mCard.GetPoints();
+      case MoveType::kCollect: {
+        auto const& take = aMove.mCollect.mTake;
+        uint32 useful{0u};
+        for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+          useful += std::min(take.Get(i), lacking.Get(i));
+        }
+        return kCollectPrior + useful;
+      }
+      case MoveType::kReserveFaceUp:
+        return kReservePrior + aMove.mReserveFaceUp.mCard.GetPoints();
+      default:
+        return 0u;
+    }
+  };
+
+  std::stable_sort(aMoves.begin(), aMoves.end(),
+                   [&](engine::Move const& aLeft, engine::Move const& aRight) {
+                     return getPrior(aLeft) > getPrior(aRight);
+                   });
+}
+
+}  // namespace agent
@@ -0,0 +1,36 @@
+#ifndef AGENT_EVALUATION_HPP
+#define AGENT_EVALUATION_HPP
+
+#include <optional>
+
+#include "util_General.hpp"
+
+namespace engine {
+class GameState;
+class MoveList;
+}  // namespace engine
+
+namespace agent {
+
+/* Static evaluation for rollouts cut short, in points: the player's points,
+ * plus a share of what their discounts, reserved cards and the nobles they
+ * are closing in on should turn into. Only reads determinized states. */
+float Evaluate(engine::GameState const& aState, uint8 aPlayer);
+
+/* The player sure to win on points because the other can no longer catch
+ * up before the game ends, if any. */
+std::optional<uint8> GetLockedWinner(engine::GameState const& aState);
+
+/* The locked winner, else the player ahead by Evaluate, or no one when the
+ * lead is too small to call. */
+std::optional<uint8> EstimateWinner(engine::GameState const& aState);
+
+/* Sorts aMoves best first by a cheap prior for the player to move: purchases
+ * by points, collects by how many of the gems they take the player still
+ * lacks for a revealed card, face up reserves by points, blind reserves
+ * last. Moves the prior cannot tell apart keep their order. */
+void OrderMoves(engine::GameState const& aState, engine::MoveList& aMoves);
+
+}  // namespace agent
+
+#endif  // AGENT_EVALUATION_HPP
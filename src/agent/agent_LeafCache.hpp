@@ -0,0 +1,138 @@
+#ifndef AGENT_LEAFCACHE_HPP
+#define AGENT_LEAFCACHE_HPP
+
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "util_General.hpp"
+
+namespace agent {
+
+/**
+ * Rollout outcomes of leaf states pooled by state hash, in a fixed table of
+ * buckets of four entries shared by the search threads. The low bits of the
+ * hash pick the bucket. Each entry packs the high half of the hash, the
+ * rollout count and the score sum into one atomic word, so readers
+ * never see half an update and writers just retry their compare exchange.
+ * A new hash takes an empty entry of its bucket, or else the one with the
+ * fewest rollouts. Counts stop growing once they would overflow their field.
+ */
+class LeafCache {
+ public:
+  struct Value {
+    uint32 mRolloutCount{0u};
+    int32 mIntScore{0};
+  };
+
+  /* aEntryCount is a multiple of the bucket size, zero disables the cache. */
+  explicit LeafCache(std::size_t aEntryCount) : mEntries(aEntryCount) {
+    ASSERT(aEntryCount % kBucketSize == 0u);
+    Clear();
+  }
+
+  bool IsEnabled() const { return !mEntries.empty(); }
+
+  std::optional<Value> Find(uint64 aHash) const {
+    if (!IsEnabled()) {
+      return std::nullopt;
+    }
+
+    std::size_t bucket = GetBucket(aHash);
+    for (std::size_t i = bucket; i < bucket + kBucketSize; ++i) {
+      uint64 entry = mEntries[i].load(std::memory_order_relaxed);
+      if (GetRolloutCount(entry) > 0u && GetHash(entry) == (aHash >> 32u)) {
+        return Unpack(entry);
+      }
+    }
+    return std::nullopt;
+  }
+
+  /* Pools aAdded into the entry of aHash and returns its totals. */
+  Value Add(uint64 aHash, Value const& aAdded) {
+    ASSERT(IsEnabled() && aAdded.mRolloutCount > 0u);
+
+    std::size_t bucket = GetBucket(aHash);
+    while (true) {
+      std::size_t victim = bucket;
+      uint64 victimEntry{0u};
+      uint32 fewest = std::numeric_limits<uint32>::max();
+      bool found{false};
+      for (std::size_t i = bucket; i < bucket + kBucketSize; ++i) {
+        uint64 entry = mEntries[i].load(std::memory_order_relaxed);
+        uint32 rolloutCount = GetRolloutCount(entry);
+        if (rolloutCount > 0u && GetHash(entry) == (aHash >> 32u)) {
+          victim = i;
+          victimEntry = entry;
+          found = true;
+          break;
+        }
+        if (rolloutCount < fewest) {
+          victim = i;
+          victimEntry = entry;
+          fewest = rolloutCount;
+        }
+      }
+
+      Value total = aAdded;
+      if (found) {
+        Value pooled = Unpack(victimEntry);
+        if (!Fits(pooled, aAdded)) {
+          return pooled;
+        }
+        total.mRolloutCount += pooled.mRolloutCount;
+        total.mIntScore += pooled.mIntScore;
+      }
+      // Starts over when another thread changed the entry meanwhile.
+      if (mEntries[victim].compare_exchange_weak(victimEntry,
+                                                 Pack(aHash, total),
+                                                 std::memory_order_relaxed)) {
+        return total;
+      }
+    }
+  }
+
+  void Clear() {
+    for (auto& entry : mEntries) {
+      entry.store(0u, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static std::size_t constexpr kBucketSize = 4u;
+  /* The high half of the hash, then the rollout count, then the score sum
+   * offset by kScoreBias. An empty entry has no rollouts. */
+  static uint32 constexpr kCountMask = 0xFFFFu;
+  static int32 constexpr kScoreBias = 0x8000;
+
+  static uint32 GetHash(uint64 aEntry) { return aEntry >> 32u; }
+  static uint32 GetRolloutCount(uint64 aEntry) {
+    return (aEntry >> 16u) & kCountMask;
+  }
+
+  static Value Unpack(uint64 aEntry) {
+    return Value{GetRolloutCount(aEntry),
+                 static_cast<int32>(aEntry & kCountMask) - kScoreBias};
+  }
+  static uint64 Pack(uint64 aHash, Value const& aValue) {
+    return ((aHash >> 32u) << 32u) | (uint64{aValue.mRolloutCount} << 16u) |
+           static_cast<uint32>(aValue.mIntScore + kScoreBias);
+  }
+
+  /* Scores never exceed rollouts in size, so the count bounds both. */
+  static bool Fits(Value const& aTotal, Value const& aAdded) {
+    return aTotal.mRolloutCount + aAdded.mRolloutCount <
+           static_cast<uint32>(kScoreBias);
+  }
+
+  std::size_t GetBucket(uint64 aHash) const {
+    return (aHash % (mEntries.size() / kBucketSize)) * kBucketSize;
+  }
+
+  std::vector<std::atomic<uint64>> mEntries;
+};
+
+}  // namespace agent
+
+#endif  // AGENT_LEAFCACHE_HPP
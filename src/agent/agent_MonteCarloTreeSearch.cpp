@@ -1,118 +1,534 @@
 #include "agent_MonteCarloTreeSearch.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <typeinfo>
 
+#include "agent_Evaluation.hpp"
+#include "agent_LeafCache.hpp"
+#include "agent_PrunedRandom.hpp"
 #include "agent_Random.hpp"
+#include "agent_Rollout.hpp"
+#include "agent_UcbBatch.hpp"
 #include "engine_GameState.hpp"
+#include "engine_MoveList.hpp"
+#include "util_Allocation.hpp"
 #include "util_Format.hpp"
+#include "util_Pool.hpp"
+#include "util_ThreadPool.hpp"
 
 namespace agent {
 
-struct MonteCarloTreeSearch::Node {
-  std::size_t mRolloutCount{};
-  long mIntScore{};
+static uint32 constexpr kInvalidNode = std::numeric_limits<uint32>::max();
+
+/* Rollouts through a node and the sum of their scores for the searching
+ * player. */
+struct MonteCarloTreeSearch::NodeStatistics {
+  std::atomic<uint32> mRolloutCount{0u};
+  std::atomic<int32> mIntScore{0};
 
   float GetScore() const { return mIntScore; }
 
-  virtual ~Node() = default;
+  void CopyFrom(NodeStatistics const& aOther) {
+    mRolloutCount = aOther.mRolloutCount.load();
+    mIntScore = aOther.mIntScore.load();
+  }
 };
 
-struct MonteCarloTreeSearch::MoveNode : public Node {
-  Move mChosen{};
-  std::vector<StateNode> mChildren{};
-  std::size_t mAvailableCount{0u};
-
-  MoveNode(engine::Move const& aMove) : mChosen(aMove) {}
+/* A state node holds the 64 bit hash of its masked state, not the state
+ * itself: Select replays the chosen moves from the root state, and the
+ * children of a move are told apart by hash, wide enough that no two states
+ * of a search are expected to share one. The moves legal in the first visit
+ * get one contiguous range of ids, moves that only later determinizations
+ * allow are chained behind it through MoveNode::mNextSibling. Without hidden
+ * information every determinization allows the same moves, so such a state
+ * marks its range as fixed, along with the GetCheck of the state it was
+ * built for. The lock guards the moves below and their child lists. */
+struct MonteCarloTreeSearch::StateNode {
+  uint64 mHash{0u};
+  NodeId mFirstMove{kInvalidNode};
+  NodeId mExtraMoves{kInvalidNode};
+  NodeId mNextSibling{kInvalidNode};
+  uint32 mCheck{0u};
+  uint16 mMoveCount{0u};
+  bool mFixedMoves{false};
+  util::SpinLock mLock{};
 };
 
-class MonteCarloTreeSearch::MoveNodeSet {
- public:
-  void Reserve(std::size_t aSize) { mStorage.reserve(aSize); }
+/* A second hash of the whole state, mixed unlike GetHash, so a state that
+ * only shares its node through a hash collision is not handed the fixed
+ * moves of another. */
+static uint32 GetCheck(engine::GameState const& aState) {
+  std::array<uint64, sizeof(engine::GameState) / sizeof(uint64)> words{};
+  memcpy(words.data(), &aState, sizeof(aState));
 
-  template <class Callable>
-  void UpsertMoves(GameState const& aGamestate, Callable&& aCallable) {
-    auto moves = aGamestate.GetMoves();
-    mStorage.reserve(moves.size());
+  uint64 check{0u};
+  for (uint64 word : words) {
+    check = (check ^ word) * 0xFF51AFD7ED558CCDull;
+    check ^= check >> 32u;
+  }
+  return static_cast<uint32>(check);
+}
 
-    for (auto const& newMove : moves) {
-      UpsertMove(newMove);
+/* Move ids of the state InitRollout works on by Move::GetKey, in an open
+ * addressing table. A slot only counts while it carries the current stamp,
+ * so Clear is one increment. */
+class MoveIndex {
+ public:
+  void Clear() {
+    mSize = 0u;
+    if (++mStamp == 0u) {
+      mSlots.fill(Slot{});
+      mStamp = 1u;
     }
+  }
 
-    for (auto const& newMove : moves) {
-      auto& node = UpsertMove(newMove);
-      aCallable(node);
+  void Insert(uint64 aKey, uint32 aId) {
+    ASSERT(mSize < kSize / 2u);
+    Slot& slot = Probe(aKey);
+    if (slot.mStamp != mStamp) {
+      slot = Slot{aKey, aId, mStamp};
+      mSize++;
     }
   }
 
+  /* kInvalidNode when aKey is not in the table. */
+  uint32 Find(uint64 aKey) {
+    Slot const& slot = Probe(aKey);
+    return slot.mStamp == mStamp ? slot.mId : kInvalidNode;
+  }
+
  private:
-  MoveNode& UpsertMove(Move const& aMove) {
-    for (auto& move : mStorage) {
-      if (move.mChosen == aMove) {
-        return move;
-      }
+  /* Twice the most moves a state collects over its determinizations. */
+  static std::size_t constexpr kSize = 512u;
+
+  struct Slot {
+    uint64 mKey{0u};
+    uint32 mId{kInvalidNode};
+    uint32 mStamp{0u};
+  };
+
+  /* The slot holding aKey, or the empty one where it would go. */
+  Slot& Probe(uint64 aKey) {
+    std::size_t i = (aKey * 0x9E3779B97F4A7C15ull) >> 55u;
+    while (mSlots[i].mStamp == mStamp && mSlots[i].mKey != aKey) {
+      i = (i + 1u) % kSize;
     }
-    mStorage.emplace_back(aMove);
-    return mStorage.back();
+    return mSlots[i];
   }
 
-  std::vector<MoveNode> mStorage;
+  std::array<Slot, kSize> mSlots{};
+  std::size_t mSize{0u};
+  uint32 mStamp{0u};
 };
 
-struct MonteCarloTreeSearch::StateNode : public Node {
-  GameState mState;
-
-  StateNode(GameState const& aState) : mState(aState) {}
-
-  std::vector<MoveNode*>& GetChildren() { return mChildren; }
-  std::vector<MoveNode*>& GetUnexplored() { return mUnexplored; }
-  GameState const& GetDeterminized() { return mDeterminized.value(); }
-
-  void ResetRollout() {
-    mChildren.clear();
-    mUnexplored.clear();
-    mDeterminized.reset();
-  }
-  void InitRollout(Generator& aGenerator) {
-    ResetRollout();
-    mDeterminized = mState;
-    mDeterminized.value().Determinize(aGenerator);
-    IterateMoves(
-        [&](MoveNode& aNode) {
-          aNode.mAvailableCount++;
-          if (aNode.mRolloutCount == 0) {
-            mUnexplored.emplace_back(&aNode);
-          } else {
-            mChildren.emplace_back(&aNode);
-          }
-        },
-        aGenerator);
+/* The child states of a move form a singly linked list through
+ * StateNode::mNextSibling. */
+struct MonteCarloTreeSearch::MoveNode {
+  NodeId mFirstChild{kInvalidNode};
+  NodeId mNextSibling{kInvalidNode};
+};
+
+/* One state on the path from the root, with the move taken from it. */
+struct MonteCarloTreeSearch::PathStep {
+  NodeId mState{kInvalidNode};
+  NodeId mMove{kInvalidNode};
+  bool mOurTurn{false};
+};
+
+/* Per-search arena. Nodes are records of struct of arrays pools, so a field
+ * such as the move statistics scanned by Select sits in one array indexed by
+ * node id. They are carved from two generations of pools: a turn that reuses
+ * part of the last tree just makes its state the root and leaves the rest of
+ * the tree in place, unreachable. Only once that takes half the node memory
+ * does Promote copy the reused subtree into the idle generation and release
+ * the old one at once.
+ *
+ * With transpositions every state node is also filed in a table of buckets
+ * of four entries, each entry packing the state hash and the node id into
+ * one atomic word. A state keeps its place in the children of the move that
+ * created it, which is what Promote copies, and other moves reach it through
+ * the table only. */
+struct MonteCarloTreeSearch::Tree {
+  NodeId mRoot{kInvalidNode};
+  NodeId mPreviousMove{kInvalidNode};
+  std::optional<GameState> mRootState{};
+  /* Nodes before the current search and iterations of its threads on this
+   * tree since, for Options::mNodeBudget. */
+  std::size_t mStartNodeCount{0u};
+  std::atomic<std::size_t> mIterationCount{0u};
+
+  Tree(std::size_t aTranspositionCount)
+      : mTranspositions(aTranspositionCount) {
+    ASSERT(aTranspositionCount % kBucketSize == 0u);
+    ClearTranspositions();
+  }
+
+  StateNode& GetState(NodeId aId) {
+    return Active().mStates.Get<kStateNode>(aId);
+  }
+  NodeStatistics& GetStateStatistics(NodeId aId) {
+    return Active().mStates.Get<kStateStatistics>(aId);
+  }
+  MoveNode& GetMove(NodeId aId) { return Active().mMoves.Get<kMoveNode>(aId); }
+  NodeStatistics& GetMoveStatistics(NodeId aId) {
+    return Active().mMoves.Get<kMoveStatistics>(aId);
+  }
+  /* Visits of the parent state in which the move was legal. */
+  uint32& GetAvailableCount(NodeId aId) {
+    return Active().mMoves.Get<kAvailableCount>(aId);
+  }
+  Move& GetChosen(NodeId aId) {
+    return Active().mMoves.Get<kChosen>(aId).mMove;
+  }
+
+  NodeId AddState(uint64 aHash) {
+    NodeId id = Active().mStates.Allocate();
+    GetState(id).mHash = aHash;
+    return id;
+  }
+  NodeId AddMoves(std::size_t aCount) {
+    return Active().mMoves.AllocateRange(aCount);
+  }
+
+  std::size_t GetNodeCount() const {
+    return GetStateCount() + mArenas[mActive].mMoves.GetSize();
+  }
+  std::size_t GetStateCount() const {
+    return mArenas[mActive].mStates.GetSize();
+  }
+  std::size_t GetNodeBytes() const {
+    auto const& active = mArenas[mActive];
+    return active.mStates.GetSize() * StatePool::kRecordSize +
+           active.mMoves.GetSize() * MovePool::kRecordSize;
+  }
+
+  void Reset() {
+    Active().Reset();
+    ClearTranspositions();
+    mRoot = kInvalidNode;
+    mPreviousMove = kInvalidNode;
+  }
+
+  /* aState becomes the root, the rest of the tree is left for Promote. */
+  void Reanchor(NodeId aState) {
+    mRoot = aState;
+    mPreviousMove = kInvalidNode;
+  }
+
+  /* Keep only the subtree under aState, which becomes the root. */
+  void Promote(NodeId aState) {
+    auto& from = Active();
+    mActive = 1u - mActive;
+    Active().Reset();
+    ClearTranspositions();
+    mRoot = CopyState(from, aState);
+    mPreviousMove = kInvalidNode;
+    from.Reset();
+  }
+
+  bool HasTranspositions() const { return !mTranspositions.empty(); }
+
+  /* Entries keep the high half of the state hash, a hit also has to match
+   * the full hash of its node, so a state reached by another move order
+   * only joins a node of the same state. */
+  NodeId FindState(uint64 aHash) {
+    if (!HasTranspositions()) {
+      return kInvalidNode;
+    }
+
+    std::size_t bucket = GetBucket(aHash);
+    for (std::size_t i = bucket; i < bucket + kBucketSize; ++i) {
+      uint64 entry = mTranspositions[i].load(std::memory_order_acquire);
+      NodeId id = static_cast<NodeId>(entry);
+      if (id != kInvalidNode && (entry >> 32u) == (aHash >> 32u) &&
+          GetState(id).mHash == aHash) {
+        return id;
+      }
+    }
+    return kInvalidNode;
+  }
+
+  /* Files aId in its bucket, in an empty entry or else over the entry whose
+   * state has the fewest rollouts. */
+  void AddTransposition(NodeId aId) {
+    if (!HasTranspositions()) {
+      return;
+    }
+
+    uint64 hash = GetState(aId).mHash;
+    std::size_t bucket = GetBucket(hash);
+    std::size_t victim = bucket;
+    uint32 fewest = std::numeric_limits<uint32>::max();
+    for (std::size_t i = bucket; i < bucket + kBucketSize; ++i) {
+      NodeId id = static_cast<NodeId>(
+          mTranspositions[i].load(std::memory_order_relaxed));
+      if (id == kInvalidNode) {
+        victim = i;
+        break;
+      }
+      uint32 rolloutCount = GetStateStatistics(id).mRolloutCount;
+      if (rolloutCount < fewest) {
+        victim = i;
+        fewest = rolloutCount;
+      }
+    }
+
+    mTranspositions[victim].store(((hash >> 32u) << 32u) | aId,
+                                  std::memory_order_release);
+  }
+
+  /* Calls aCallable with the id of every move of aState, the contiguous
+   * range first. */
+  template <class Callable>
+  void ForEachMove(StateNode const& aState, Callable&& aCallable) {
+    ForEachMove(Active(), aState, aCallable);
+  }
+
+  template <class Callable>
+  void ForEachState(NodeId aMove, Callable&& aCallable) {
+    for (NodeId id = GetMove(aMove).mFirstChild; id != kInvalidNode;) {
+      NodeId next = GetState(id).mNextSibling;
+      aCallable(id);
+      id = next;
+    }
   }
 
  private:
+  enum : std::size_t { kStateStatistics, kStateNode };
+  enum : std::size_t { kMoveStatistics, kAvailableCount, kChosen, kMoveNode };
+
+  using StatePool = util::Pool<NodeStatistics, StateNode>;
+  /* Move has no default constructor of its own for the pool to call. */
+  struct Chosen {
+    Move mMove{};
+  };
+
+  using MovePool = util::Pool<NodeStatistics, uint32, Chosen, MoveNode>;
+
+  struct Arena {
+    StatePool mStates{};
+    MovePool mMoves{};
+
+    void Reset() {
+      mStates.Reset();
+      mMoves.Reset();
+    }
+  };
+
+  static std::size_t constexpr kBucketSize = 4u;
+
+  Arena& Active() { return mArenas[mActive]; }
+
+  std::size_t GetBucket(uint64 aHash) const {
+    return (aHash % (mTranspositions.size() / kBucketSize)) * kBucketSize;
+  }
+
+  void ClearTranspositions() {
+    for (auto& entry : mTranspositions) {
+      entry.store(kInvalidNode, std::memory_order_relaxed);
+    }
+  }
+
+  /* The copy folds the extra moves into the contiguous range. */
+  NodeId CopyState(Arena& aFrom, NodeId aState) {
+    auto const& from = aFrom.mStates.Get<kStateNode>(aState);
+    NodeId id = AddState(from.mHash);
+    GetStateStatistics(id).CopyFrom(
+        aFrom.mStates.Get<kStateStatistics>(aState));
+    AddTransposition(id);
+
+    std::size_t moveCount{0u};
+    ForEachMove(aFrom, from, [&](NodeId) { moveCount++; });
+    if (moveCount == 0u) {
+      return id;
+    }
+
+    NodeId first = AddMoves(moveCount);
+    GetState(id).mFirstMove = first;
+    GetState(id).mMoveCount = static_cast<uint16>(moveCount);
+    // Extra moves can only come from a state sharing the node by collision.
+    if (from.mFixedMoves && from.mExtraMoves == kInvalidNode) {
+      GetState(id).mFixedMoves = true;
+      GetState(id).mCheck = from.mCheck;
+    }
+    NodeId copy = first;
+    ForEachMove(aFrom, from,
+                [&](NodeId aMove) { CopyMove(aFrom, aMove, copy++); });
+    return id;
+  }
+
+  void CopyMove(Arena& aFrom, NodeId aMove, NodeId aCopy) {
+    GetMoveStatistics(aCopy).CopyFrom(
+        aFrom.mMoves.Get<kMoveStatistics>(aMove));
+    GetAvailableCount(aCopy) = aFrom.mMoves.Get<kAvailableCount>(aMove);
+    GetChosen(aCopy) = aFrom.mMoves.Get<kChosen>(aMove).mMove;
+
+    NodeId* link = &GetMove(aCopy).mFirstChild;
+    for (NodeId state = aFrom.mMoves.Get<kMoveNode>(aMove).mFirstChild;
+         state != kInvalidNode;
+         state = aFrom.mStates.Get<kStateNode>(state).mNextSibling) {
+      NodeId copy = CopyState(aFrom, state);
+      *link = copy;
+      link = &GetState(copy).mNextSibling;
+    }
+  }
+
   template <class Callable>
-  void IterateMoves(Callable&& aCallable, Generator& aGenerator) {
-    mMoveNodes.UpsertMoves(mDeterminized.value(), std::move(aCallable));
+  static void ForEachMove(Arena& aArena, StateNode const& aState,
+                          Callable&& aCallable) {
+    for (uint16 i = 0u; i < aState.mMoveCount; ++i) {
+      aCallable(aState.mFirstMove + i);
+    }
+    for (NodeId id = aState.mExtraMoves; id != kInvalidNode;
+         id = aArena.mMoves.Get<kMoveNode>(id).mNextSibling) {
+      aCallable(id);
+    }
   }
 
-  MoveNodeSet mMoveNodes{};
-  std::vector<MoveNode*> mChildren{};
-  std::vector<MoveNode*> mUnexplored{};
+  std::array<Arena, 2u> mArenas{};
+  std::size_t mActive{0u};
+  std::vector<std::atomic<uint64>> mTranspositions;
+};
+
+/* Everything a single search thread owns: its random stream, its rollout
+ * policy and the tree it grows, which kTree shares between threads. Select
+ * keeps the state at the back of its path here, masked and determinized,
+ * with the moves legal in the latter and the statistics of those already
+ * explored. kPerIteration only keeps the determinized state, which the
+ * whole iteration plays in, and the masked hash. */
+struct MonteCarloTreeSearch::Worker {
+  Generator mGenerator;
+  std::unique_ptr<engine::IAgent> mRolloutAgent{};
+  engine::Runner mRunner{};
+  std::vector<GameState> mRolloutStates{};
+  std::vector<std::optional<uint8>> mWinners{};
+  Tree* mTree{nullptr};
+  std::optional<GameState> mState{};
   std::optional<GameState> mDeterminized{};
+  uint64 mHash{0u};
+  std::array<NodeId, engine::MoveList::kCapacity> mAvailable{};
+  std::size_t mAvailableCount{0u};
+  std::size_t mUnexploredCount{0u};
+  UcbBatch mUcb{};
+  MoveIndex mMoveIndex{};
+  std::size_t mMaxPath{0u};
+  std::size_t mRolloutCount{0u};
+  std::size_t mPlayedRolloutCount{0u};
+  std::size_t mAllocationCount{0u};
+  std::size_t mTranspositionCount{0u};
+  std::size_t mLeafCacheHitCount{0u};
+  std::size_t mLeafCacheMissCount{0u};
+  std::size_t mSkippedClockCount{0u};
+
+  Worker(Generator aGenerator, Options const& aOptions)
+      : mGenerator{aGenerator},
+        mRolloutAgent{aOptions.mMakeRolloutPolicy(mGenerator)},
+        mMaxPlyCount{aOptions.mMaxRolloutPlies},
+        mPerIteration{aOptions.mDeterminization ==
+                      Options::Determinization::kPerIteration} {
+    mRunner.AddAgent(mRolloutAgent.get());
+    mRunner.AddAgent(mRolloutAgent.get());
+
+    auto const& type = typeid(*mRolloutAgent);
+    if (type == typeid(SmartRollout)) {
+      mPlayRollouts = &PlayFast<SmartRollout>;
+    } else if (type == typeid(PrunedRandom)) {
+      mPlayRollouts = &PlayFast<PrunedRandom>;
+    } else if (type == typeid(Random)) {
+      mPlayRollouts = &PlayFast<Random>;
+    }
+  }
+
+  /* Plays determinized states to the end, or to mMaxRolloutPlies, with the
+   * rollout policy: in lockstep through RunRollouts when the policy is one
+   * of ours, else one game after the other through the Runner, since other
+   * agents may keep state per game. */
+  void PlayRollouts(std::span<GameState> aStates,
+                    std::span<std::optional<uint8>> aWinners) {
+    mPlayRollouts(*this, aStates, aWinners);
+  }
+
+  /* The state at the back of the path the rollouts start from. */
+  GameState const& GetLeaf() const {
+    return mPerIteration ? *mDeterminized : *mState;
+  }
+
+ private:
+  using Play = void (*)(Worker& aWorker, std::span<GameState> aStates,
+                        std::span<std::optional<uint8>> aWinners);
+
+  template <class Policy>
+  static void PlayFast(Worker& aWorker, std::span<GameState> aStates,
+                       std::span<std::optional<uint8>> aWinners) {
+    RunRollouts(static_cast<Policy&>(*aWorker.mRolloutAgent), aStates,
+                aWinners, aWorker.mGenerator, aWorker.mMaxPlyCount);
+  }
+
+  static void PlayWithRunner(Worker& aWorker, std::span<GameState> aStates,
+                             std::span<std::optional<uint8>> aWinners) {
+    for (std::size_t i = 0u; i < aStates.size(); ++i) {
+      aWinners[i] = aWorker.mRunner.RunGame(aStates[i], aWorker.mGenerator,
+                                            aWorker.mMaxPlyCount);
+      if (!aStates[i].IsTerminal()) {
+        aWinners[i] = EstimateWinner(aStates[i]);
+      }
+    }
+  }
+
+  std::size_t mMaxPlyCount;
+  bool mPerIteration;
+  Play mPlayRollouts{&PlayWithRunner};
+};
+
+struct MonteCarloTreeSearch::MoveStatistics {
+  Move mChosen{};
+  std::size_t mRolloutCount{0u};
+  long mIntScore{0};
+
+  float GetScore() const { return mIntScore; }
 };
 
 MonteCarloTreeSearch::MonteCarloTreeSearch(Generator& aGenerator,
                                            Options const& aOptions)
     : mGenerator{aGenerator},
       mOptions{std::move(aOptions)},
-      mRolloutAgent{aOptions.mMakeRolloutPolicy(aGenerator)} {
-  mRunner.AddAgent(mRolloutAgent.get());
-  mRunner.AddAgent(mRolloutAgent.get());
+      mLeafCache{std::make_unique<LeafCache>(mOptions.mLeafCacheSize)} {
+  ASSERT(mOptions.mThreadCount > 0u);
+  ASSERT(mOptions.mSimsPerRollout > 0u &&
+         mOptions.mSimsPerRollout <= kMaxRolloutCount);
+  ASSERT(mOptions.mClockInterval > 0u);
+
+  uint64 seed = mOptions.mSeed ? *mOptions.mSeed : mGenerator();
+  for (std::size_t i = 0u; i < mOptions.mThreadCount; ++i) {
+    mWorkers.emplace_back(
+        std::make_unique<Worker>(util::MakeGenerator(seed, i), mOptions));
+  }
+
+  for (std::size_t i = 0u; i < GetTreeCount(); ++i) {
+    mTrees.emplace_back(std::make_unique<Tree>(
+        mOptions.mTranspositions ? mOptions.mTranspositionCount : 0u));
+  }
+
+  for (std::size_t i = 0u; i < mWorkers.size(); ++i) {
+    mWorkers[i]->mTree = mTrees[i % mTrees.size()].get();
+  }
+
+  // Pondering needs the pool to search in the background.
+  if (mWorkers.size() > 1u || mOptions.mPonder) {
+    mThreadPool = std::make_unique<util::ThreadPool>(mWorkers.size());
+  }
 }
 
-MonteCarloTreeSearch::~MonteCarloTreeSearch() {}
+MonteCarloTreeSearch::~MonteCarloTreeSearch() { StopPondering(); }
 
 void MonteCarloTreeSearch::OnSetup(GameState const& aState, uint8 aPlayerId) {
+  StopPondering();
   ResetHistory();
   mPlayerId = aPlayerId;
 }
@@ -120,217 +536,706 @@ void MonteCarloTreeSearch::OnSetup(GameState const& aState, uint8 aPlayerId) {
 engine::Move MonteCarloTreeSearch::OnTurn(GameState const& aState) {
   TimeStamp start{};
 
-  auto root = TrackActualAction(aState);
-  StateNode storage{aState};
-  if (!root) {
-    root = &storage;
+  std::size_t ponderedCount = StopPondering();
+  std::size_t reusedCount{0u};
+  for (auto& tree : mTrees) {
+    reusedCount += PrepareRoot(*tree, aState);
+  }
+  mIterationCount.store(0u, std::memory_order_relaxed);
+  mPlayedRolloutCount.store(0u, std::memory_order_relaxed);
+
+  if (mThreadPool) {
+    mThreadPool->Run([&](std::size_t aThreadIndex) {
+      Search(*mWorkers[aThreadIndex], start, false);
+    });
+  } else {
+    Search(*mWorkers.front(), start, false);
+  }
+
+  GameState determinized = aState;
+  determinized.Determinize(mGenerator);
+  engine::MoveList legal{};
+  determinized.GetMoves(legal);
+  auto merged = MergeRoots(legal);
+  ASSERT(!merged.empty());
+
+  mStatistics = Statistics{};
+  mStatistics.mSeconds = start.Since();
+  mStatistics.mReusedRolloutCount = reusedCount;
+  mStatistics.mPonderedRolloutCount = ponderedCount;
+  for (auto const& worker : mWorkers) {
+    mStatistics.mRolloutCount += worker->mRolloutCount;
+    mStatistics.mPlayedRolloutCount += worker->mPlayedRolloutCount;
+    mStatistics.mMaxPath = std::max(mStatistics.mMaxPath, worker->mMaxPath);
+    mStatistics.mAllocationCount += worker->mAllocationCount;
+    mStatistics.mTranspositionCount += worker->mTranspositionCount;
+    mStatistics.mLeafCacheHitCount += worker->mLeafCacheHitCount;
+    mStatistics.mLeafCacheMissCount += worker->mLeafCacheMissCount;
+  }
+  for (auto const& tree : mTrees) {
+    mStatistics.mNodeCount += tree->GetNodeCount();
+    mStatistics.mAddedNodeCount =
+        std::max(mStatistics.mAddedNodeCount,
+                 tree->GetNodeCount() - tree->mStartNodeCount);
+    mStatistics.mStateCount += tree->GetStateCount();
+    mStatistics.mNodeBytes += tree->GetNodeBytes();
+  }
+
+  if (mOptions.mDebug) {
+    ShowDebug(merged);
+  }
+
+  auto best = util::MaxElement(merged.begin(), merged.end(),
+                               [](MoveStatistics const& aMove) {
+                                 ASSERT(aMove.mRolloutCount > 0);
+                                 return aMove.GetScore() / aMove.mRolloutCount;
+                               });
+  Move chosen = best->mChosen;
+
+  for (auto& tree : mTrees) {
+    tree->ForEachMove(tree->GetState(tree->mRoot), [&](NodeId aMove) {
+      if (tree->GetChosen(aMove) == chosen) {
+        tree->mPreviousMove = aMove;
+      }
+    });
+  }
+
+  if (mOptions.mPonder) {
+    StartPondering();
+  }
+  return chosen;
+}
+
+/* Searches below the move just chosen until StopPondering. */
+void MonteCarloTreeSearch::StartPondering() {
+  ASSERT(!mPondering);
+  mStopPondering.store(false, std::memory_order_relaxed);
+  mPondering = true;
+  mThreadPool->Start([this](std::size_t aThreadIndex) {
+    Search(*mWorkers[aThreadIndex], TimeStamp{}, true);
+  });
+}
+
+/* Returns the rollouts played since StartPondering, if it was called. */
+std::size_t MonteCarloTreeSearch::StopPondering() {
+  if (!mPondering) {
+    return 0u;
+  }
+
+  mStopPondering.store(true, std::memory_order_relaxed);
+  mThreadPool->Wait();
+  mPondering = false;
+
+  std::size_t rolloutCount{0u};
+  for (auto const& worker : mWorkers) {
+    rolloutCount += worker->mRolloutCount;
+  }
+  return rolloutCount;
+}
+
+/* Returns the rollouts the root carries over from earlier turns. */
+std::size_t MonteCarloTreeSearch::PrepareRoot(Tree& aTree,
+                                              GameState const& aState) {
+  NodeId root = TrackActualAction(aTree, aState);
+  if (root == kInvalidNode) {
+    aTree.Reset();
+    aTree.mRoot = aTree.AddState(aState.GetHash());
+    aTree.AddTransposition(aTree.mRoot);
+  } else if (aTree.GetNodeBytes() >= mOptions.mMaxNodeBytes / 2u) {
+    aTree.Promote(root);
+  } else {
+    aTree.Reanchor(root);
+  }
+  aTree.mRootState = aState;
+  aTree.mStartNodeCount = aTree.GetNodeCount();
+  aTree.mIterationCount.store(0u, std::memory_order_relaxed);
+  return aTree.GetStateStatistics(aTree.mRoot).mRolloutCount;
+}
+
+/* Grows the worker's tree until the time limit, or with aPonder only below
+ * the move last played from the root, until StopPondering. */
+void MonteCarloTreeSearch::Search(Worker& aWorker, TimeStamp const& aStart,
+                                  bool aPonder) {
+  auto& tree = *aWorker.mTree;
+  aWorker.mMaxPath = 0u;
+  aWorker.mRolloutCount = 0u;
+  aWorker.mPlayedRolloutCount = 0u;
+  aWorker.mTranspositionCount = 0u;
+  aWorker.mLeafCacheHitCount = 0u;
+  aWorker.mLeafCacheMissCount = 0u;
+  aWorker.mSkippedClockCount = 0u;
+
+  NodeId ponderMove = aPonder ? tree.mPreviousMove : kInvalidNode;
+  if (aPonder && ponderMove == kInvalidNode) {
+    return;
   }
 
-  std::size_t maxPath{0};
+  std::size_t allocationCount = util::GetAllocationCount();
 
-  std::vector<Node*> expandPath;
+  bool ourTurn = tree.mRootState->GetNextPlayer() == mPlayerId;
+  std::vector<PathStep> expandPath;
   while (true) {
     expandPath.clear();
-    root->InitRollout(mGenerator);
-    expandPath.emplace_back(root);
-    Select(expandPath);
+    expandPath.push_back(PathStep{tree.mRoot, kInvalidNode, ourTurn});
+    if (IsPerIteration()) {
+      aWorker.mDeterminized = tree.mRootState;
+      aWorker.mDeterminized->Determinize(aWorker.mGenerator);
+    } else {
+      aWorker.mState = tree.mRootState;
+    }
+    aWorker.mHash = tree.mRootState->GetHash();
+    bool traced = ponderMove == kInvalidNode ||
+                  ForceMove(aWorker, expandPath, ponderMove);
+    // A move that ends the game leaves nothing to ponder on, and no turn
+    // would come to stop the search.
+    if (ponderMove != kInvalidNode && aWorker.GetLeaf().IsTerminal()) {
+      break;
+    }
+    if (traced) {
+      Select(aWorker, expandPath);
+    }
 
-    auto back = dynamic_cast<StateNode*>(expandPath.back());
+    std::size_t playedCount{0u};
+    char score =
+        Heuristic(aWorker, aWorker.GetLeaf(), aWorker.mHash, playedCount);
+    Backup(tree, expandPath, score);
 
-    ASSERT(back);
+    /* Counted in nodes, states and moves alike. */
+    aWorker.mMaxPath = std::max(2u * expandPath.size() - 1u, aWorker.mMaxPath);
+    aWorker.mRolloutCount += mOptions.mSimsPerRollout;
+    aWorker.mPlayedRolloutCount += playedCount;
 
-    if (!back->GetUnexplored().empty()) {
-      Expand(expandPath);
+    if (aPonder ? mStopPondering.load(std::memory_order_relaxed)
+                : CheckLimit(aWorker, aStart, playedCount)) {
+      break;
     }
+  }
 
-    char score = Heuristic(*back);
-    Backup(expandPath, score);
+  aWorker.mAllocationCount = util::GetAllocationCount() - allocationCount;
+}
 
-    maxPath = std::max(expandPath.size(), maxPath);
+/* Whether the search is over once the worker finished an iteration that
+ * played aPlayedCount rollouts. */
+bool MonteCarloTreeSearch::CheckLimit(Worker& aWorker, TimeStamp const& aStart,
+                                      std::size_t aPlayedCount) {
+  if (mOptions.mIterationBudget > 0u || mOptions.mRolloutBudget > 0u ||
+      mOptions.mNodeBudget > 0u) {
+    std::size_t iterationCount =
+        mIterationCount.fetch_add(1u, std::memory_order_relaxed) + 1u;
+    if (mOptions.mIterationBudget > 0u &&
+        iterationCount >= mOptions.mIterationBudget) {
+      return true;
+    }
+    // Leaves that are terminal or answered by the leaf cache play nothing,
+    // while an iteration that plays plays at least one: the budget caps
+    // both.
+    if (mOptions.mRolloutBudget > 0u) {
+      std::size_t playedCount =
+          mPlayedRolloutCount.fetch_add(aPlayedCount,
+                                        std::memory_order_relaxed) +
+          aPlayedCount;
+      if (playedCount >= mOptions.mRolloutBudget ||
+          iterationCount >= mOptions.mRolloutBudget) {
+        return true;
+      }
+    }
 
-    if (CheckLimit(start)) {
-      break;
+    // Near the end of a game the tree may stop growing, while an iteration
+    // that grows it adds at least one node: the budget caps both per tree.
+    auto& tree = *aWorker.mTree;
+    if (mOptions.mNodeBudget > 0u) {
+      std::size_t treeIterationCount =
+          tree.mIterationCount.fetch_add(1u, std::memory_order_relaxed) + 1u;
+      if (treeIterationCount >= mOptions.mNodeBudget ||
+          tree.GetNodeCount() - tree.mStartNodeCount >= mOptions.mNodeBudget) {
+        return true;
+      }
     }
   }
 
-  ASSERT(!root->GetChildren().empty());
+  if (++aWorker.mSkippedClockCount < mOptions.mClockInterval) {
+    return false;
+  }
+  aWorker.mSkippedClockCount = 0u;
+  return aStart.Since() >= mOptions.mTimeoutSeconds;
+}
+
+/* Sums the root moves of all trees, leaving out those aLegal lacks. */
+std::vector<MonteCarloTreeSearch::MoveStatistics>
+MonteCarloTreeSearch::MergeRoots(engine::MoveList const& aLegal) const {
+  std::vector<MoveStatistics> merged{};
 
-  if (mOptions.mDebug) {
-    std::sort(root->GetChildren().begin(), root->GetChildren().end(),
-              [](MoveNode const* aLeft, MoveNode const* aRight) {
-                return aLeft->GetScore() / aLeft->mRolloutCount >
-                       aRight->GetScore() / aRight->mRolloutCount;
-              });
-    std::cout << "player " << static_cast<uint16>(mPlayerId + 1)
-              << " rollouts: " << root->mRolloutCount
-              << " strength: " << (root->GetScore() / root->mRolloutCount)
-              << " depth: " << maxPath << std::endl;
-    for (std::size_t i = 0; i < std::min(10ul, root->GetChildren().size());
-         ++i) {
-      auto const& move = root->GetChildren()[i]->mChosen;
-      std::cout << "score:" << std::fixed << std::setprecision(5)
-                << (root->GetChildren()[i]->GetScore() /
-                    root->GetChildren()[i]->mRolloutCount)
-                << '\t';
-      std::cout << "sims:" << root->GetChildren()[i]->mRolloutCount << '\t';
-      util::ShowMove(std::cout, mPlayerId, move);
-      std::cout << '\n';
-    }
-    std::cout << "\n";
-  }
-
-  auto best =
-      util::MaxElement(root->GetChildren().begin(), root->GetChildren().end(),
-                       [](MoveNode const* aMove) {
-                         ASSERT(aMove->mRolloutCount > 0);
-                         return aMove->GetScore() / aMove->mRolloutCount;
-                       });
-  mPreviousMove = std::make_unique<MoveNode>(std::move(**best));
-  return mPreviousMove->mChosen;
+  for (auto const& tree : mTrees) {
+    tree->ForEachMove(tree->GetState(tree->mRoot), [&](NodeId aChild) {
+      auto const& statistics = tree->GetMoveStatistics(aChild);
+      if (statistics.mRolloutCount == 0u) {
+        return;
+      }
+
+      Move const& chosen = tree->GetChosen(aChild);
+      if (std::find(aLegal.begin(), aLegal.end(), chosen) == aLegal.end()) {
+        return;
+      }
+      auto it = std::find_if(
+          merged.begin(), merged.end(),
+          [&](MoveStatistics const& aMove) { return aMove.mChosen == chosen; });
+      if (it == merged.end()) {
+        merged.push_back(MoveStatistics{chosen});
+        it = merged.end() - 1;
+      }
+      it->mRolloutCount += statistics.mRolloutCount;
+      it->mIntScore += statistics.mIntScore;
+    });
+  }
+
+  return merged;
+}
+
+void MonteCarloTreeSearch::ShowDebug(
+    std::vector<MoveStatistics>& aMerged) const {
+  std::size_t rolloutCount{0u};
+  long intScore{0};
+
+  for (auto const& tree : mTrees) {
+    auto const& root = tree->GetStateStatistics(tree->mRoot);
+    rolloutCount += root.mRolloutCount;
+    intScore += root.mIntScore;
+  }
+
+  if (mWorkers.size() > 1u) {
+    for (std::size_t i = 0u; i < mWorkers.size(); ++i) {
+      auto const& worker = *mWorkers[i];
+      std::cout << "thread " << i << " rollouts: " << worker.mRolloutCount
+                << " depth: " << worker.mMaxPath
+                << " allocations: " << worker.mAllocationCount << std::endl;
+    }
+  }
+
+  std::sort(aMerged.begin(), aMerged.end(),
+            [](MoveStatistics const& aLeft, MoveStatistics const& aRight) {
+              return aLeft.GetScore() / aLeft.mRolloutCount >
+                     aRight.GetScore() / aRight.mRolloutCount;
+            });
+  std::cout << "player " << static_cast<uint16>(mPlayerId + 1)
+            << " rollouts: " << rolloutCount
+            << " strength: " << (static_cast<float>(intScore) / rolloutCount)
+            << " depth: " << mStatistics.mMaxPath
+            << " nodes: " << mStatistics.mNodeCount
+            << " transpositions: " << mStatistics.mTranspositionCount
+            << " allocations: " << mStatistics.mAllocationCount
+            << " reused: " << mStatistics.mReusedRolloutCount
+            << " pondered: " << mStatistics.mPonderedRolloutCount << std::endl;
+  if (mLeafCache->IsEnabled()) {
+    std::cout << "leaf cache hits: " << mStatistics.mLeafCacheHitCount
+              << " misses: " << mStatistics.mLeafCacheMissCount << std::endl;
+  }
+  for (std::size_t i = 0; i < std::min(10ul, aMerged.size()); ++i) {
+    auto const& move = aMerged[i];
+    std::cout << "score:" << std::fixed << std::setprecision(5)
+              << (move.GetScore() / move.mRolloutCount) << '\t';
+    std::cout << "sims:" << move.mRolloutCount << '\t';
+    util::ShowMove(std::cout, mPlayerId, move.mChosen);
+    std::cout << '\n';
+  }
+  std::cout << "\n";
+}
+
+/* The score of mSimsPerRollout rollouts from aLeaf: played, or scaled from
+ * what the leaf cache pooled for its masked hash aHash. aPlayedCount gets
+ * the rollouts actually played, none for a terminal leaf. */
+char MonteCarloTreeSearch::Heuristic(Worker& aWorker, GameState const& aLeaf,
+                                     uint64 aHash,
+                                     std::size_t& aPlayedCount) const {
+  aPlayedCount = 0u;
+  auto playOut = [&] {
+    if (!aLeaf.IsTerminal()) {
+      aPlayedCount = mOptions.mSimsPerRollout;
+    }
+    return PlayOut(aWorker, aLeaf);
+  };
+
+  if (!mLeafCache->IsEnabled()) {
+    return playOut();
+  }
+
+  auto pooled = mLeafCache->Find(aHash);
+  (pooled ? aWorker.mLeafCacheHitCount : aWorker.mLeafCacheMissCount)++;
+  if (!pooled || pooled->mRolloutCount < mOptions.mLeafCacheRollouts) {
+    uint32 rolloutCount = static_cast<uint32>(mOptions.mSimsPerRollout);
+    pooled = mLeafCache->Add(
+        aHash, LeafCache::Value{rolloutCount, playOut()});
+  }
+  return static_cast<char>(std::lround(static_cast<float>(pooled->mIntScore) *
+                                       mOptions.mSimsPerRollout /
+                                       pooled->mRolloutCount));
 }
 
-char MonteCarloTreeSearch::Heuristic(StateNode const& aLeaf) const {
+/* Plays mSimsPerRollout determinizations of aLeaf as one batch, the same
+ * one over and over when aLeaf is already determinized. */
+char MonteCarloTreeSearch::PlayOut(Worker& aWorker,
+                                   GameState const& aLeaf) const {
+  auto& states = aWorker.mRolloutStates;
+  states.assign(mOptions.mSimsPerRollout, aLeaf);
+  for (auto& state : states) {
+    state.Determinize(aWorker.mGenerator);
+  }
+
+  aWorker.mWinners.resize(states.size());
+  aWorker.PlayRollouts(states, aWorker.mWinners);
+
   char score{0};
-  for (std::size_t i = 0u; i < mOptions.mSimsPerRollout; ++i) {
-    score += Simulate(aLeaf.mState);
+  for (auto const& winner : aWorker.mWinners) {
+    score += Score(winner);
   }
   return score;
 }
 
-void MonteCarloTreeSearch::ResetHistory() { mPreviousMove.reset(); }
+void MonteCarloTreeSearch::ResetHistory() {
+  for (auto& tree : mTrees) {
+    tree->Reset();
+  }
+  mLeafCache->Clear();
+}
 
-MonteCarloTreeSearch::StateNode* MonteCarloTreeSearch::TrackActualAction(
-    GameState const& aState) {
-  if (!mPreviousMove) {
-    return nullptr;
+MonteCarloTreeSearch::NodeId MonteCarloTreeSearch::TrackActualAction(
+    Tree& aTree, GameState const& aState) {
+  if (aTree.mPreviousMove == kInvalidNode) {
+    return kInvalidNode;
   }
 
   if (!mOptions.mTraceHistory) {
-    return nullptr;
+    return kInvalidNode;
+  }
+
+  // Hashes may collide, so a node that kept the check of its state must also
+  // match that, or the new root would offer moves aState does not allow.
+  uint64 hash = aState.GetHash();
+  std::optional<uint32> check{};
+  if (!aState.HasHiddenInformation(mPlayerId)) {
+    GameState state = aState;
+    if (IsPerIteration()) {
+      state.Determinize(mGenerator);
+    }
+    check = GetCheck(state);
+  }
+  auto matches = [&](NodeId aId) {
+    auto const& node = aTree.GetState(aId);
+    return node.mHash == hash && (!node.mFixedMoves || node.mCheck == check);
+  };
+
+  if (aTree.HasTranspositions()) {
+    NodeId id = aTree.FindState(hash);
+    return id != kInvalidNode && matches(id) ? id : kInvalidNode;
   }
   TimeStamp start{};
 
-  for (auto& state : mPreviousMove->mChildren) {
-    if (state.mState == aState) {
+  NodeId found{kInvalidNode};
+  aTree.ForEachState(aTree.mPreviousMove, [&](NodeId aState1) {
+    if (found == kInvalidNode && matches(aState1)) {
       if (mOptions.mDebug) {
-        std::cout << "traced single: " << state.mRolloutCount << " rollouts in "
-                  << (TimeStamp{} - start) << "s" << std::endl;
+        std::cout << "traced single: "
+                  << aTree.GetStateStatistics(aState1).mRolloutCount
+                  << " rollouts in " << (TimeStamp{} - start) << "s"
+                  << std::endl;
       }
-      return &state;
+      found = aState1;
     }
+  });
+  if (found != kInvalidNode) {
+    return found;
   }
 
-  for (auto& state1 : mPreviousMove->mChildren) {
-    state1.InitRollout(mGenerator);
-    for (auto& move : state1.GetChildren()) {
-      for (auto& state2 : move->mChildren) {
-        if (state2.mState == aState) {
+  aTree.ForEachState(aTree.mPreviousMove, [&](NodeId aState1) {
+    aTree.ForEachMove(aTree.GetState(aState1), [&](NodeId aMove) {
+      aTree.ForEachState(aMove, [&](NodeId aState2) {
+        if (found == kInvalidNode && matches(aState2)) {
           if (mOptions.mDebug) {
-            std::cout << "traced double: " << state2.mRolloutCount
+            std::cout << "traced double: "
+                      << aTree.GetStateStatistics(aState2).mRolloutCount
                       << " rollouts in " << (TimeStamp{} - start) << "s"
                       << std::endl;
           }
-          return &state2;
+          found = aState2;
         }
+      });
+    });
+  });
+
+  return found;
+}
+
+/* Legal moves a state with these statistics may consider. */
+std::size_t MonteCarloTreeSearch::GetWidth(
+    NodeStatistics const& aStatistics) const {
+  if (!mOptions.mProgressiveWidening) {
+    return engine::MoveList::kCapacity;
+  }
+
+  float visitCount = aStatistics.mRolloutCount / mOptions.mSimsPerRollout;
+  float width = mOptions.mWideningFactor *
+                std::pow(visitCount, mOptions.mWideningExponent);
+  return std::clamp<std::size_t>(static_cast<std::size_t>(width), 1u,
+                                 engine::MoveList::kCapacity);
+}
+
+/* Gathers the moves legal in a fresh determinization of the worker's state,
+ * or with kPerIteration in the iteration's one, keeping the aWidth with the
+ * lowest ids: OrderMoves order, then moves that only later determinizations
+ * allowed. A fixed range is taken as is, other states generate their moves
+ * and look them up through the move index. Caller holds the lock on aNode. */
+void MonteCarloTreeSearch::InitRollout(Worker& aWorker, StateNode& aNode,
+                                       std::size_t aWidth) {
+  auto& tree = *aWorker.mTree;
+  if (!IsPerIteration()) {
+    aWorker.mDeterminized.emplace(*aWorker.mState)
+        .Determinize(aWorker.mGenerator);
+  }
+  // kPerIteration checks fixed ranges against the determinized state, which
+  // where nothing is hidden only differs from the masked one by its flag.
+  auto const& state = aWorker.GetLeaf();
+  auto const& determinized = *aWorker.mDeterminized;
+  aWorker.mAvailableCount = 0u;
+  aWorker.mUnexploredCount = 0u;
+  aWorker.mUcb.clear();
+
+  bool fixed = aNode.mFixedMoves && aNode.mCheck == GetCheck(state);
+  if (!fixed) {
+    engine::MoveList moves{};
+    determinized.GetMoves(moves);
+    if (aNode.mFirstMove == kInvalidNode && !moves.empty() &&
+        CanGrow(tree, moves.size())) {
+      if (mOptions.mProgressiveWidening) {
+        OrderMoves(determinized, moves);
+      }
+      aNode.mFirstMove = tree.AddMoves(moves.size());
+      aNode.mMoveCount = static_cast<uint16>(moves.size());
+      for (std::size_t i = 0u; i < moves.size(); ++i) {
+        tree.GetChosen(aNode.mFirstMove + i) = moves[i];
       }
+      if (!state.HasHiddenInformation(mPlayerId)) {
+        aNode.mFixedMoves = true;
+        aNode.mCheck = GetCheck(state);
+        fixed = true;
+      }
+    }
+
+    if (!fixed) {
+      aWorker.mMoveIndex.Clear();
+      tree.ForEachMove(aNode, [&](NodeId aId) {
+        aWorker.mMoveIndex.Insert(tree.GetChosen(aId).GetKey(), aId);
+      });
+      for (auto const& move : moves) {
+        NodeId id = UpsertMove(aWorker, aNode, move);
+        if (id == kInvalidNode) {
+          continue;
+        }
+        ++tree.GetAvailableCount(id);
+        aWorker.mAvailable[aWorker.mAvailableCount++] = id;
+      }
+    }
+  }
+
+  if (fixed) {
+    for (uint16 i = 0u; i < aNode.mMoveCount; ++i) {
+      NodeId id = aNode.mFirstMove + i;
+      ++tree.GetAvailableCount(id);
+      aWorker.mAvailable[aWorker.mAvailableCount++] = id;
     }
   }
 
-  return nullptr;
+  auto available = aWorker.mAvailable.begin();
+  if (aWorker.mAvailableCount > aWidth) {
+    std::nth_element(available, available + aWidth,
+                     available + aWorker.mAvailableCount);
+    aWorker.mAvailableCount = aWidth;
+  }
+
+  for (std::size_t i = 0u; i < aWorker.mAvailableCount; ++i) {
+    NodeId id = available[i];
+    uint32 availableCount = tree.GetAvailableCount(id);
+    auto const& statistics = tree.GetMoveStatistics(id);
+    uint32 rolloutCount = statistics.mRolloutCount;
+    if (rolloutCount == 0u) {
+      aWorker.mUnexploredCount++;
+    } else {
+      aWorker.mUcb.push_back(rolloutCount, statistics.mIntScore,
+                             availableCount);
+    }
+  }
 }
 
-void MonteCarloTreeSearch::Select(std::vector<Node*>& aPath) {
-  StateNode* back = dynamic_cast<StateNode*>(aPath.back());
-  ASSERT(back);
-  if (!back->GetUnexplored().empty()) {
-    /* Unexplored actions on this path, we should explore them before going
-     * deeper. */
-    return;
+/* Whether aTree has node memory for aCount more nodes, and with
+ * Options::mNodeBudget room for them in the current search's budget. */
+bool MonteCarloTreeSearch::CanGrow(Tree const& aTree,
+                                   std::size_t aCount) const {
+  if (aTree.GetNodeBytes() >= mOptions.mMaxNodeBytes) {
+    return false;
   }
+  return mOptions.mNodeBudget == 0u ||
+         aTree.GetNodeCount() - aTree.mStartNodeCount + aCount <=
+             mOptions.mNodeBudget;
+}
 
-  if (back->GetChildren().empty()) {
-    /* Terminal node (everything explored, no children), can't grow. */
-    ASSERT(back->mState.IsTerminal());
-    return;
+/* Looks aMove up in the worker's move index, filled with the moves of
+ * aNode, and chains a new move node behind the range when it is not there.
+ * Invalid once the tree is out of node memory or budget. */
+MonteCarloTreeSearch::NodeId MonteCarloTreeSearch::UpsertMove(
+    Worker& aWorker, StateNode& aNode, Move const& aMove) {
+  auto& tree = *aWorker.mTree;
+  uint64 key = aMove.GetKey();
+  NodeId found = aWorker.mMoveIndex.Find(key);
+  if (found != kInvalidNode) {
+    return found;
   }
 
-  ASSERT(back->mRolloutCount > 0);
+  if (!CanGrow(tree, 1u)) {
+    return kInvalidNode;
+  }
 
-  float factor = back->mState.GetNextPlayer() == mPlayerId ? 1.0 : -1.0;
+  NodeId id = tree.AddMoves(1u);
+  tree.GetChosen(id) = aMove;
+  tree.GetMove(id).mNextSibling = aNode.mExtraMoves;
+  aNode.mExtraMoves = id;
+  aWorker.mMoveIndex.Insert(key, id);
+  return id;
+}
 
-  auto max = util::MaxElement(
-      back->GetChildren().begin(), back->GetChildren().end(),
-      [&](MoveNode const* aChild) {
-        ASSERT(aChild->mRolloutCount > 0);
-        float value = factor * aChild->GetScore() / aChild->mRolloutCount +
-                      std::sqrt(mOptions.mUpperConfidenceBound *
-                                std::log(aChild->mAvailableCount) /
-                                aChild->mRolloutCount);
-        return value;
-      });
+void MonteCarloTreeSearch::Select(Worker& aWorker,
+                                  std::vector<PathStep>& aPath) {
+  auto& tree = *aWorker.mTree;
 
-  /* Grow path and keep trying to find something to expand. */
-  MoveNode* moveNode = *max;
-  aPath.emplace_back(moveNode);
+  while (true) {
+    PathStep const& back = aPath.back();
+    auto& node = tree.GetState(back.mState);
 
-  StateNode* nextState = TraceMove(back->GetDeterminized(), moveNode);
-  nextState->InitRollout(mGenerator);
-  aPath.emplace_back(nextState);
+    std::lock_guard<util::SpinLock> lock{node.mLock};
+    InitRollout(aWorker, node,
+                GetWidth(tree.GetStateStatistics(back.mState)));
 
-  Select(aPath);
-}
+    if (aWorker.mUnexploredCount > 0u) {
+      /* Unexplored actions on this path, we should explore them before going
+       * deeper. */
+      Expand(aWorker, aPath);
+      return;
+    }
+
+    if (aWorker.mAvailableCount == 0u) {
+      /* Terminal node (everything explored, no children), or out of node
+       * memory or budget, can't grow. */
+      ASSERT(aWorker.GetLeaf().IsTerminal() || !CanGrow(tree, 1u));
+      return;
+    }
+
+    /* With a shared tree another thread may have explored every child
+     * without backing up through this node yet. */
+    ASSERT(tree.GetStateStatistics(back.mState).mRolloutCount > 0u ||
+           IsTreeParallel());
 
-void MonteCarloTreeSearch::Expand(std::vector<Node*>& aPath) {
-  StateNode* back = dynamic_cast<StateNode*>(aPath.back());
-  ASSERT(back);
+    float factor = back.mOurTurn ? 1.0 : -1.0;
 
-  auto& unexplored = back->GetUnexplored();
-  auto it = unexplored.begin() + mGenerator() % unexplored.size();
-  auto moveNode = *it;
-  unexplored.erase(it);
-  back->GetChildren().emplace_back(moveNode);
-  auto stateNode = TraceMove(back->GetDeterminized(), moveNode);
-  stateNode->InitRollout(mGenerator);
+    /* Every available move is explored, so the batch lines up with them. */
+    ASSERT(aWorker.mUcb.size() == aWorker.mAvailableCount);
+    std::size_t best =
+        aWorker.mUcb.ArgMax(factor, mOptions.mUpperConfidenceBound);
+    NodeId moveNode = aWorker.mAvailable[best];
 
-  aPath.push_back(moveNode);
-  aPath.push_back(stateNode);
+    /* Grow path and keep trying to find something to expand. */
+    if (!TraceMove(aWorker, aPath, moveNode)) {
+      return;
+    }
+  }
 }
 
-MonteCarloTreeSearch::StateNode* MonteCarloTreeSearch::TraceMove(
-    GameState const& aStart, MoveNode* aMoveNode) {
-  switch (aMoveNode->mChosen.mType) {
-    case engine::MoveType::kCollect:
-    case engine::MoveType::kReturn:
-    case engine::MoveType::kNoble:
-      // These moves are always deterministic.
-      if (aMoveNode->mChildren.size() == 1) {
-        return &aMoveNode->mChildren.back();
-      }
-      break;
-    default:
+/* Caller holds the lock on the back of the path. */
+void MonteCarloTreeSearch::Expand(Worker& aWorker,
+                                  std::vector<PathStep>& aPath) {
+  auto& tree = *aWorker.mTree;
+  std::size_t pick =
+      util::Uniform(aWorker.mGenerator, aWorker.mUnexploredCount);
+
+  NodeId moveNode{kInvalidNode};
+  for (std::size_t i = 0u; i < aWorker.mAvailableCount; ++i) {
+    NodeId child = aWorker.mAvailable[i];
+    if (tree.GetMoveStatistics(child).mRolloutCount == 0u && pick-- == 0u) {
+      moveNode = child;
       break;
+    }
   }
 
-  // Otherwise the move results in a randomized state
-  GameState aCopy = aStart;
-  aCopy.DoMove(aMoveNode->mChosen, mGenerator);
-  aCopy = aCopy.MaskHiddenInformation(mPlayerId);
+  ASSERT(moveNode != kInvalidNode);
+  TraceMove(aWorker, aPath, moveNode);
+}
+
+/* Plays aMove from the worker's determinized state and appends the masked
+ * outcome to the path, as a child of aMove or through the transposition
+ * table. kPerIteration plays it in place and only hashes the masked state.
+ * False, leaving the path alone, once the tree is out of node memory or
+ * budget: the move is played all the same, so the rollouts start after it.
+ * Caller holds the lock on the back of the path. */
+bool MonteCarloTreeSearch::TraceMove(Worker& aWorker,
+                                     std::vector<PathStep>& aPath,
+                                     NodeId aMove) {
+  auto& tree = *aWorker.mTree;
 
-  for (auto& existing : aMoveNode->mChildren) {
-    if (existing.mState == aCopy) {
-      return &existing;
+  if (IsPerIteration()) {
+    auto& determinized = *aWorker.mDeterminized;
+    determinized.DoMove(tree.GetChosen(aMove), aWorker.mGenerator);
+    aWorker.mHash = determinized.GetMaskedHash(mPlayerId);
+  } else {
+    auto& next = aWorker.mState.emplace(*aWorker.mDeterminized);
+    next.DoMove(tree.GetChosen(aMove), aWorker.mGenerator);
+    next = next.MaskHiddenInformation(mPlayerId);
+    aWorker.mHash = next.GetHash();
+  }
+  uint64 hash = aWorker.mHash;
+
+  NodeId id{kInvalidNode};
+  tree.ForEachState(aMove, [&](NodeId aChild) {
+    if (id == kInvalidNode && tree.GetState(aChild).mHash == hash) {
+      id = aChild;
+    }
+  });
+
+  if (id == kInvalidNode) {
+    id = tree.FindState(hash);
+    if (id != kInvalidNode) {
+      aWorker.mTranspositionCount++;
+    }
+  }
+
+  if (id == kInvalidNode) {
+    if (!CanGrow(tree, 1u)) {
+      return false;
     }
+
+    id = tree.AddState(hash);
+    auto& move = tree.GetMove(aMove);
+    tree.GetState(id).mNextSibling = move.mFirstChild;
+    move.mFirstChild = id;
+    tree.AddTransposition(id);
   }
 
-  aMoveNode->mChildren.emplace_back(aCopy);
-  return &aMoveNode->mChildren.back();
+  bool ourTurn = aPath.back().mOurTurn;
+  AddVirtualLoss(ourTurn, tree.GetMoveStatistics(aMove));
+  AddVirtualLoss(ourTurn, tree.GetStateStatistics(id));
+  aPath.back().mMove = aMove;
+  aPath.push_back(PathStep{id, kInvalidNode,
+                           aWorker.GetLeaf().GetNextPlayer() == mPlayerId});
+  return true;
 }
 
-char MonteCarloTreeSearch::Simulate(GameState const& aState) const {
-  GameState local = aState;
-  local.Determinize(mGenerator);
-  auto winner = mRunner.RunGame(local, mGenerator);
-  return Score(winner);
+/* Appends aMove, a move of the root, to a path holding only the root: the
+ * first step of Select without its choice. */
+bool MonteCarloTreeSearch::ForceMove(Worker& aWorker,
+                                     std::vector<PathStep>& aPath,
+                                     NodeId aMove) {
+  auto& root = aWorker.mTree->GetState(aPath.back().mState);
+  std::lock_guard<util::SpinLock> lock{root.mLock};
+  if (!IsPerIteration()) {
+    aWorker.mDeterminized.emplace(*aWorker.mState)
+        .Determinize(aWorker.mGenerator);
+  }
+  return TraceMove(aWorker, aPath, aMove);
 }
 
 char MonteCarloTreeSearch::Score(std::optional<uint8> aWinner) const {
@@ -341,12 +1246,56 @@ char MonteCarloTreeSearch::Score(std::optional<uint8> aWinner) const {
   return (aWinner.value() == mPlayerId) ? 1 : -1;
 }
 
-void MonteCarloTreeSearch::Backup(std::vector<Node*> const& aPath,
+void MonteCarloTreeSearch::Backup(Tree& aTree,
+                                  std::vector<PathStep> const& aPath,
                                   char aScore) const {
-  for (auto node : aPath) {
-    node->mRolloutCount += mOptions.mSimsPerRollout;
-    node->mIntScore += aScore;
+  auto visit = [&](NodeStatistics& aStatistics) {
+    aStatistics.mRolloutCount += mOptions.mSimsPerRollout;
+    aStatistics.mIntScore += aScore;
+  };
+
+  for (std::size_t i = 0u; i < aPath.size(); ++i) {
+    auto const& step = aPath[i];
+    auto& state = aTree.GetStateStatistics(step.mState);
+    visit(state);
+    if (i > 0u) {
+      RemoveVirtualLoss(aPath[i - 1u].mOurTurn, state);
+    }
+
+    if (step.mMove != kInvalidNode) {
+      auto& move = aTree.GetMoveStatistics(step.mMove);
+      visit(move);
+      RemoveVirtualLoss(step.mOurTurn, move);
+    }
+  }
+}
+
+int32 MonteCarloTreeSearch::GetVirtualLoss(bool aOurTurn) const {
+  int32 loss = static_cast<int32>(mOptions.mVirtualLoss);
+  return aOurTurn ? -loss : loss;
+}
+
+/* Count a visit that is still in flight as a loss for the player choosing
+ * the move above aStatistics, so other threads spread over different
+ * branches meanwhile. */
+void MonteCarloTreeSearch::AddVirtualLoss(bool aOurTurn,
+                                          NodeStatistics& aStatistics) const {
+  if (!IsTreeParallel()) {
+    return;
+  }
+
+  aStatistics.mRolloutCount += mOptions.mVirtualLoss;
+  aStatistics.mIntScore += GetVirtualLoss(aOurTurn);
+}
+
+void MonteCarloTreeSearch::RemoveVirtualLoss(
+    bool aOurTurn, NodeStatistics& aStatistics) const {
+  if (!IsTreeParallel()) {
+    return;
   }
+
+  aStatistics.mRolloutCount -= mOptions.mVirtualLoss;
+  aStatistics.mIntScore -= GetVirtualLoss(aOurTurn);
 }
 
-}  // namespace agent
\ No newline at end of file
+}  // namespace agent
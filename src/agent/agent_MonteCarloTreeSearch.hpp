@@ -1,6 +1,7 @@
 #ifndef AGENT_MONTECARLOTREESEARCH_HPP
 #define AGENT_MONTECARLOTREESEARCH_HPP
 
+#include <atomic>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -17,10 +18,33 @@ class GameState;
 class Move;
 }  // namespace engine
 
+namespace util {
+class ThreadPool;
+}  // namespace util
+
 namespace agent {
 
+class LeafCache;
+
 struct MonteCarloTreeSearchOptions {
   float mTimeoutSeconds{0.1f};
+  /* Budgets besides the timeout, zero leaves one out: iterations and
+   * rollouts of all threads together, and nodes added to each tree, which a
+   * single threaded search never grows past. Only rollouts actually played
+   * count, see Statistics::mPlayedRolloutCount.
+   * The rollout and node budgets also cap the iterations, for searches
+   * that stop playing or growing near the end of a game. The search
+   * stops at the first one spent, so a single threaded search with an
+   * infinite timeout and mSeed set plays the same on any machine, unless
+   * it ponders: how long the opponent thinks decides how far pondering
+   * grows the tree and advances the generators. */
+  std::size_t mIterationBudget{0u};
+  std::size_t mRolloutBudget{0u};
+  std::size_t mNodeBudget{0u};
+  /* Seeds the search threads instead of the generator handed over. */
+  std::optional<uint64> mSeed{};
+  /* Each thread only reads the clock every this many iterations. */
+  std::size_t mClockInterval{1u};
   float mUpperConfidenceBound{0.8f};
   bool mTraceHistory{true};
   std::unique_ptr<engine::IAgent> (*mMakeRolloutPolicy)(
@@ -29,7 +53,90 @@ struct MonteCarloTreeSearchOptions {
     return std::make_unique<agent::SmartRollout>(aGenerator);
   };
   bool mDebug{false};
+  /* Games played out from each leaf, at most kMaxRolloutCount, see
+   * RunRollouts. */
   std::size_t mSimsPerRollout{5u};
+  /* Rollouts stop after this many plies, or once GetLockedWinner settles
+   * them, and EstimateWinner scores the position they stopped in. Rollout
+   * policies played through the Runner only stop at the cap. */
+  std::size_t mMaxRolloutPlies{engine::Runner::kNoPlyLimit};
+  std::size_t mThreadCount{1u};
+  /* kRoot: each thread grows its own tree, the root statistics are merged
+   * before picking a move. kTree: all threads grow one shared tree. */
+  enum class Parallelism : uint8 { kRoot, kTree };
+  Parallelism mParallelism{Parallelism::kRoot};
+  /* Rollouts counted as losses for every thread still below a node, only used
+   * by kTree. */
+  std::size_t mVirtualLoss{5u};
+  /* Look child states up in a table of mTranspositionCount entries keyed by
+   * the masked state hash, so states reached by different move orders share
+   * one node and its statistics: the tree becomes a DAG. When the table is
+   * full the least visited state of a bucket makes room. */
+  bool mTranspositions{false};
+  std::size_t mTranspositionCount{1u << 16u};
+  /* The tree stops growing once its nodes take this many bytes, rollouts
+   * then start from the deepest node reached. The subtree reused for the
+   * next turn stays in place with the rest of the old tree around it, until
+   * the nodes take half this: then it is copied out, briefly held twice,
+   * and the rest dropped. */
+  std::size_t mMaxNodeBytes{std::size_t{1u} << 30u};
+  /* Pool the rollout outcomes of leaves by masked state hash in a table of
+   * mLeafCacheSize entries shared by the threads and kept over the turns of
+   * a game, zero turns it off. A leaf reached again plays its batch and
+   * backs up the mean of everything pooled for it, until it has
+   * mLeafCacheRollouts pooled: from then on it backs up that mean without
+   * playing. */
+  std::size_t mLeafCacheSize{0u};
+  std::size_t mLeafCacheRollouts{20u};
+  /* Moves get their nodes in OrderMoves order on the first visit of a
+   * state, and a state visited n times only considers its first
+   * mWideningFactor * n ^ mWideningExponent legal moves in that order, so
+   * the search settles on fewer moves and goes deeper. */
+  bool mProgressiveWidening{false};
+  float mWideningFactor{1.0f};
+  float mWideningExponent{0.5f};
+  /* kPerNode: every state on the selection path is determinized afresh to
+   * list its moves. kPerIteration: single observer information set MCTS,
+   * each iteration determinizes the root once and plays its path and
+   * rollouts in that one state. Nodes stay keyed by the masked hash either
+   * way. */
+  enum class Determinization : uint8 { kPerNode, kPerIteration };
+  Determinization mDeterminization{Determinization::kPerNode};
+  /* Keep searching in the background from OnTurn until the next call,
+   * growing the subtree of the move played so the reply that comes is
+   * already explored. Takes mThreadCount threads for the opponent's whole
+   * turn, and after the last turn of a game until OnSetup or destruction. */
+  bool mPonder{false};
+};
+
+struct MonteCarloTreeSearchStatistics {
+  std::size_t mRolloutCount{0u};
+  /* Rollouts actually played, leaving out leaves the leaf cache answered
+   * and terminal leaves. */
+  std::size_t mPlayedRolloutCount{0u};
+  std::size_t mMaxPath{0u};
+  float mSeconds{0.0f};
+  /* Nodes in the tree pools, counting those earlier turns left unreachable
+   * until the reused subtree is copied out. */
+  std::size_t mNodeCount{0u};
+  std::size_t mStateCount{0u};
+  /* Most nodes this search added to one tree, what mNodeBudget caps. */
+  std::size_t mAddedNodeCount{0u};
+  /* Bytes those nodes take in the tree pools. */
+  std::size_t mNodeBytes{0u};
+  /* Child states found in the transposition table rather than below the
+   * move that led to them. */
+  std::size_t mTranspositionCount{0u};
+  /* Heap allocations made by the search threads, zero unless built with
+   * COUNT_ALLOCATIONS, see util_Allocation.hpp. */
+  std::size_t mAllocationCount{0u};
+  /* Leaves found in the leaf cache and leaves it did not know yet. */
+  std::size_t mLeafCacheHitCount{0u};
+  std::size_t mLeafCacheMissCount{0u};
+  /* Rollouts the root kept from the searches of earlier turns. */
+  std::size_t mReusedRolloutCount{0u};
+  /* Rollouts played while pondering on the opponent's turn. */
+  std::size_t mPonderedRolloutCount{0u};
 };
 
 class MonteCarloTreeSearch : public engine::IAgent {
@@ -38,6 +145,7 @@ class MonteCarloTreeSearch : public engine::IAgent {
   using GameState = engine::GameState;
   using Move = engine::Move;
   using Options = MonteCarloTreeSearchOptions;
+  using Statistics = MonteCarloTreeSearchStatistics;
 
   MonteCarloTreeSearch(Generator& aGenerator,
                        Options const& aOptions = Options{});
@@ -46,36 +154,79 @@ class MonteCarloTreeSearch : public engine::IAgent {
   void OnSetup(GameState const& aState, uint8 aPlayerId) override;
   Move OnTurn(GameState const& aState) override;
 
+  /* Totals of the search behind the last OnTurn. */
+  Statistics const& GetStatistics() const { return mStatistics; }
+
  private:
   using TimeStamp = util::TimeStamp;
+  using NodeId = uint32;
 
-  struct Node;
+  struct NodeStatistics;
   struct MoveNode;
   struct StateNode;
-  class MoveNodeSet;
-
-  char Heuristic(StateNode const& aLeaf) const;
+  struct PathStep;
+  struct Tree;
+  struct Worker;
+  struct MoveStatistics;
 
-  bool CheckLimit(TimeStamp const& aStart) {
-    return aStart.Since() >= mOptions.mTimeoutSeconds;
+  bool IsTreeParallel() const {
+    return mOptions.mParallelism == Options::Parallelism::kTree;
   }
+  std::size_t GetTreeCount() const {
+    return IsTreeParallel() ? 1u : mWorkers.size();
+  }
+  bool IsPerIteration() const {
+    return mOptions.mDeterminization ==
+           Options::Determinization::kPerIteration;
+  }
+
+  std::size_t PrepareRoot(Tree& aTree, GameState const& aState);
+  void Search(Worker& aWorker, TimeStamp const& aStart, bool aPonder);
+  void StartPondering();
+  std::size_t StopPondering();
+  std::vector<MoveStatistics> MergeRoots(
+      engine::MoveList const& aLegal) const;
+  void ShowDebug(std::vector<MoveStatistics>& aMerged) const;
+
+  char Heuristic(Worker& aWorker, GameState const& aLeaf, uint64 aHash,
+                 std::size_t& aPlayedCount) const;
+  char PlayOut(Worker& aWorker, GameState const& aLeaf) const;
+
+  bool CheckLimit(Worker& aWorker, TimeStamp const& aStart,
+                  std::size_t aPlayedCount);
 
   void ResetHistory();
 
-  StateNode* TrackActualAction(GameState const& aState);
-  void Select(std::vector<Node*>& aPath);
-  void Expand(std::vector<Node*>& aPath);
-  StateNode* TraceMove(GameState const& aStart, MoveNode* aMoveNode);
-  char Simulate(GameState const& aState) const;
+  NodeId TrackActualAction(Tree& aTree, GameState const& aState);
+  std::size_t GetWidth(NodeStatistics const& aStatistics) const;
+  bool CanGrow(Tree const& aTree, std::size_t aCount) const;
+  void InitRollout(Worker& aWorker, StateNode& aNode, std::size_t aWidth);
+  NodeId UpsertMove(Worker& aWorker, StateNode& aNode, Move const& aMove);
+  void Select(Worker& aWorker, std::vector<PathStep>& aPath);
+  void Expand(Worker& aWorker, std::vector<PathStep>& aPath);
+  bool TraceMove(Worker& aWorker, std::vector<PathStep>& aPath, NodeId aMove);
+  bool ForceMove(Worker& aWorker, std::vector<PathStep>& aPath, NodeId aMove);
   char Score(std::optional<uint8> aWinner) const;
-  void Backup(std::vector<Node*> const& aPath, char aScore) const;
+  void Backup(Tree& aTree, std::vector<PathStep> const& aPath,
+              char aScore) const;
+  int32 GetVirtualLoss(bool aOurTurn) const;
+  void AddVirtualLoss(bool aOurTurn, NodeStatistics& aStatistics) const;
+  void RemoveVirtualLoss(bool aOurTurn, NodeStatistics& aStatistics) const;
 
-  std::unique_ptr<MoveNode> mPreviousMove{};
   uint8 mPlayerId{};
-  engine::Runner mRunner{};
   Generator& mGenerator;
   Options mOptions;
-  std::unique_ptr<engine::IAgent> mRolloutAgent{};
+  std::vector<std::unique_ptr<Tree>> mTrees{};
+  std::vector<std::unique_ptr<Worker>> mWorkers{};
+  std::unique_ptr<util::ThreadPool> mThreadPool{};
+  std::unique_ptr<LeafCache> mLeafCache;
+  Statistics mStatistics{};
+  bool mPondering{false};
+  std::atomic<bool> mStopPondering{false};
+  /* Iterations of the current search over all threads. */
+  std::atomic<std::size_t> mIterationCount{0u};
+  /* Rollouts the current search played over all threads. */
+  std::atomic<std::size_t> mPlayedRolloutCount{0u};
 };
 }  // namespace agent
 
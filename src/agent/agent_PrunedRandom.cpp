@@ -2,17 +2,21 @@
 
 #include "engine_GameState.hpp"
 #include "engine_Move.hpp"
+#include "engine_MoveList.hpp"
 
 namespace agent {
 
 engine::Move PrunedRandom::OnTurn(engine::GameState const& aState) {
   auto state = aState;
   state.Determinize(mGenerator);
-  auto moves = state.GetMoves();
-  std::vector<engine::Move> purchase{};
-  std::vector<engine::Move> collect{};
-  purchase.reserve(moves.size());
-  collect.reserve(moves.size());
+  return SelectMove(state);
+}
+
+engine::Move PrunedRandom::SelectMove(engine::GameState const& aState) {
+  engine::MoveList moves{};
+  aState.GetMoves(moves);
+  engine::MoveList purchase{};
+  engine::MoveList collect{};
 
   for (auto const& move : moves) {
     if (move.mType == engine::MoveType::kCollect) {
@@ -23,14 +27,14 @@ engine::Move PrunedRandom::OnTurn(engine::GameState const& aState) {
   }
 
   if (!purchase.empty()) {
-    return purchase[mGenerator() % purchase.size()];
+    return purchase[util::Uniform(mGenerator, purchase.size())];
   }
 
   if (!collect.empty() && collect.front().mCollect.mTake.GetCount() > 0) {
-    return collect[mGenerator() % collect.size()];
+    return collect[util::Uniform(mGenerator, collect.size())];
   }
 
-  return moves[mGenerator() % moves.size()];
+  return moves[util::Uniform(mGenerator, moves.size())];
 }
 
 }  // namespace agent
\ No newline at end of file
@@ -19,6 +19,8 @@ class PrunedRandom : public engine::IAgent {
   void OnSetup(engine::GameState const& aState, uint8 aPlayerId) override {}
 
   engine::Move OnTurn(engine::GameState const& aState) override;
+  /* OnTurn for a state that is already determinized, see RunRollouts. */
+  engine::Move SelectMove(engine::GameState const& aState);
 
  private:
   Generator& mGenerator;
@@ -4,6 +4,7 @@
 #include "engine_GameState.hpp"
 #include "engine_IAgent.hpp"
 #include "engine_Move.hpp"
+#include "engine_MoveList.hpp"
 #include "util_General.hpp"
 
 namespace agent {
@@ -22,8 +23,14 @@ class Random : public engine::IAgent {
   engine::Move OnTurn(engine::GameState const& aState) override {
     auto state = aState;
     state.Determinize(mGenerator);
-    auto moves = state.GetMoves();
-    return moves[mGenerator() % moves.size()];
+    return SelectMove(state);
+  }
+
+  /* OnTurn for a state that is already determinized, see RunRollouts. */
+  engine::Move SelectMove(engine::GameState const& aState) {
+    engine::MoveList moves{};
+    aState.GetMoves(moves);
+    return moves[util::Uniform(mGenerator, moves.size())];
   }
 
  private:
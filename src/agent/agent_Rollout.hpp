@@ -0,0 +1,72 @@
+#ifndef AGENT_ROLLOUT_HPP
+#define AGENT_ROLLOUT_HPP
+
+#include <array>
+#include <optional>
+#include <span>
+
+#include "agent_Evaluation.hpp"
+#include "engine_GameState.hpp"
+#include "engine_Move.hpp"
+#include "engine_Runner.hpp"
+#include "util_General.hpp"
+
+namespace agent {
+
+/* Most games one RunRollouts call plays. */
+static std::size_t constexpr kMaxRolloutCount = 64u;
+
+/**
+ * Runner::RunGame for a batch of rollouts, played in lockstep: one ply of
+ * each unfinished game per round. The states must already be determinized,
+ * each ply asks aPolicy.SelectMove for the move straight from the state and
+ * plays it in place: no masking, no views, no virtual calls and no copies.
+ * Rollout policies only look at what the player to move can see and keep
+ * nothing per game, so this plays the same games as handing them masked
+ * states through the Runner one game at a time.
+ * With aMaxPlyCount set, a game still running after that many plies, or
+ * already decided by GetLockedWinner, stops there and EstimateWinner names
+ * its winner. Returns the number of plies played.
+ */
+template <class Policy>
+std::size_t RunRollouts(
+    Policy& aPolicy, std::span<engine::GameState> aStates,
+    std::span<std::optional<uint8>> aWinners, util::Generator& aGenerator,
+    std::size_t aMaxPlyCount = engine::Runner::kNoPlyLimit) {
+  ASSERT(aStates.size() == aWinners.size() &&
+         aStates.size() <= kMaxRolloutCount);
+
+  std::array<uint8, kMaxRolloutCount> active{};
+  std::size_t activeCount{0u};
+  for (std::size_t game = 0u; game < aStates.size(); ++game) {
+    active[activeCount++] = game;
+  }
+
+  bool cutoff = aMaxPlyCount != engine::Runner::kNoPlyLimit;
+  std::size_t plyCount{0u};
+  // Every unfinished game has played exactly ply plies.
+  for (std::size_t ply = 0u; activeCount > 0u; ++ply) {
+    for (std::size_t i = 0u; i < activeCount;) {
+      auto& state = aStates[active[i]];
+      if (state.IsTerminal()) {
+        aWinners[active[i]] = state.GetWinner();
+        active[i] = active[--activeCount];
+        continue;
+      }
+      if (cutoff && (ply == aMaxPlyCount || GetLockedWinner(state))) {
+        aWinners[active[i]] = EstimateWinner(state);
+        active[i] = active[--activeCount];
+        continue;
+      }
+
+      state.DoMove(aPolicy.SelectMove(state), aGenerator);
+      plyCount++;
+      ++i;
+    }
+  }
+  return plyCount;
+}
+
+}  // namespace agent
+
+#endif  // AGENT_ROLLOUT_HPP
@@ -3,6 +3,7 @@
 
 #include "engine_GameState.hpp"
 #include "engine_Move.hpp"
+#include "engine_MoveList.hpp"
 #include "util_General.hpp"
 
 namespace agent {
@@ -10,15 +11,18 @@ namespace agent {
 engine::Move SmartRollout::OnTurn(engine::GameState const& aState) {
   auto state = aState;
   state.Determinize(mGenerator);
-  auto moves = state.GetMoves();
+  return SelectMove(state);
+}
+
+engine::Move SmartRollout::SelectMove(engine::GameState const& aState) {
+  engine::MoveList moves{};
+  aState.GetMoves(moves);
 
-  engine::Gemset cardCosts = GetCardCost(state);
-  engine::Gemset nobleCosts = GetNobleCost(state);
+  GemCounts cardCosts = GetCardCost(aState);
+  engine::Gemset nobleCosts = GetNobleCost(aState);
 
-  std::vector<engine::Move> purchase{};
-  std::vector<engine::Move> collect{};
-  purchase.reserve(moves.size());
-  collect.reserve(moves.size());
+  engine::MoveList purchase{};
+  engine::MoveList collect{};
 
   for (auto const& move : moves) {
     if (move.mType == engine::MoveType::kCollect) {
@@ -42,7 +46,7 @@ engine::Move SmartRollout::OnTurn(engine::GameState const& aState) {
     return SelectCollectMove(collect, cardCosts);
   }
 
-  return moves[mGenerator() % moves.size()];
+  return moves[util::Uniform(mGenerator, moves.size())];
 }
 
 engine::Gemset SmartRollout::GetNobleCost(
@@ -56,49 +60,47 @@ engine::Gemset SmartRollout::GetNobleCost(
   return nobleCosts;
 }
 
-engine::Gemset SmartRollout::GetCardCost(
+SmartRollout::GemCounts SmartRollout::GetCardCost(
     engine::GameState const& aState) const {
-  auto const& player = aState.GetPlayers()[aState.GetNextPlayer()];
-  auto purchasePower =
-      engine::Gemset::Add(player.GetDiscount(), player.GetHeld());
-
-  // Get costs for cards we are close to purchasing (missing <= 6 resources)
-  engine::Gemset cardCosts{};
-  auto addCosts = [&](engine::DevelopmentCard const& aCard) {
-    if (!aCard) {
-      return;
-    }
-
-    auto discountCost =
-        engine::Gemset::ApplyDiscount(aCard.GetCost(), purchasePower);
+  using engine::GameState;
+  using engine::Gemset;
 
-    if (discountCost.GetCount() + player.GetGold() <=
-        mOptions.mNearTermCostThreshold) {
-      cardCosts = engine::Gemset::Add(cardCosts, discountCost);
-    }
-  };
+  auto const& player = aState.GetPlayers()[aState.GetNextPlayer()];
+  if (player.GetGold() > mOptions.mNearTermCostThreshold) {
+    return GemCounts{};
+  }
 
-  for (auto const& row : aState.GetRevealedDevelopmentCards()) {
-    for (auto const& card : row) {
-      addCosts(card);
+  GameState::PurchaseArray<engine::DevelopmentCard> cards{};
+  GameState::PurchaseArray<Gemset> costs{};
+  GameState::PurchaseArray<Gemset> missing{};
+  uint32 nearTerm = aState.GetPurchaseCandidates(cards, costs);
+
+  // Get costs for cards we are close to purchasing: missing at most the
+  // threshold less the gold held
+  auto purchasePower = Gemset::Add(player.GetDiscount(), player.GetHeld());
+  nearTerm &= Gemset::GetAffordableMask(
+      purchasePower, mOptions.mNearTermCostThreshold - player.GetGold(), costs,
+      missing);
+
+  GemCounts cardCosts{};
+  util::IterateBitfield(nearTerm, [&](std::size_t aIndex) {
+    for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+      cardCosts[i] += missing[aIndex].Get(i);
     }
-  }
-  for (auto const& card : player.GetReservedDevelopmentCards()) {
-    addCosts(card);
-  }
+  });
 
   return cardCosts;
 }
 
 engine::Move SmartRollout::SelectCollectMove(
-    std::vector<engine::Move> const& aMoves, engine::Gemset const& aCardCost) {
+    engine::MoveList const& aMoves, GemCounts const& aCardCost) {
   return util::WeightedSample(
       aMoves,
       [&](std::size_t aIndex) {
         std::size_t weight{1ul};
         auto const& take = aMoves[aIndex].mCollect.mTake;
         for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
-          weight += take.Get(i) * aCardCost.Get(i);
+          weight += take.Get(i) * aCardCost[i];
         }
         return weight;
       },
@@ -106,7 +108,7 @@ engine::Move SmartRollout::SelectCollectMove(
 }
 
 engine::Move SmartRollout::SelectPurchaseMove(
-    std::vector<engine::Move> const& aMoves, engine::Gemset const& aCardCost,
+    engine::MoveList const& aMoves, GemCounts const& aCardCost,
     engine::Gemset const& aNobleCost) {
   return util::WeightedSample(
       aMoves,
@@ -115,7 +117,7 @@ engine::Move SmartRollout::SelectPurchaseMove(
 
         size_t weight{1ul};
 
-        weight += aCardCost.Get(card.GetColor()) *
+        weight += aCardCost[static_cast<std::size_t>(card.GetColor())] *
                   mOptions.mPurchaseForDevelopmentCardWeight;
         weight += aNobleCost.Get(card.GetColor()) *
                   mOptions.mPurchaseForNobleCardWeight;
@@ -1,10 +1,14 @@
 #ifndef AGENT_SMARTROLLOUT_HPP
 #define AGENT_SMARTROLLOUT_HPP
 
+#include <array>
+
+#include "engine_Gemset.hpp"
 #include "engine_IAgent.hpp"
 
 namespace engine {
 class Gemset;
+class MoveList;
 }
 
 namespace agent {
@@ -25,15 +29,21 @@ class SmartRollout : public engine::IAgent {
       : mGenerator(aGenerator), mOptions(aOptions) {}
 
   void OnSetup(engine::GameState const& aState, uint8 aPlayerId) override {}
-  engine::Move OnTurn(engine::GameState const& aState);
+  engine::Move OnTurn(engine::GameState const& aState) override;
+  /* OnTurn for a state that is already determinized, see RunRollouts. */
+  engine::Move SelectMove(engine::GameState const& aState);
 
  private:
+  /* Gems per color, in counters wider than the Gemset lanes: the missing
+   * gems of up to 15 cards add up past Gemset::kMaxCount. */
+  using GemCounts = std::array<uint32, engine::kGemColorCount>;
+
   engine::Gemset GetNobleCost(engine::GameState const& aState) const;
-  engine::Gemset GetCardCost(engine::GameState const& aState) const;
-  engine::Move SelectCollectMove(std::vector<engine::Move> const& aMoves,
-                                 engine::Gemset const& aCardCost);
-  engine::Move SelectPurchaseMove(std::vector<engine::Move> const& aMoves,
-                                  engine::Gemset const& aCardCost,
+  GemCounts GetCardCost(engine::GameState const& aState) const;
+  engine::Move SelectCollectMove(engine::MoveList const& aMoves,
+                                 GemCounts const& aCardCost);
+  engine::Move SelectPurchaseMove(engine::MoveList const& aMoves,
+                                  GemCounts const& aCardCost,
                                   engine::Gemset const& aNobleCost);
 
   Generator& mGenerator;
@@ -0,0 +1,212 @@
+#ifndef AGENT_UCBBATCH_HPP
+#define AGENT_UCBBATCH_HPP
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "engine_MoveList.hpp"
+#include "util_General.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace agent {
+
+/* The UCB argmax either loops over the children or evaluates a register of
+ * them at once, eight with AVX and four with SSE2. The scalar loop stays
+ * around as the reference. */
+enum class UcbKernel : uint8 { kScalar, kSimd };
+static UcbKernel constexpr kUcbKernel = UcbKernel::kSimd;
+
+/**
+ * Statistics of the children of one state, gathered into contiguous arrays
+ * for a single selection: UCB1 value
+ *
+ *   factor * score / rollouts + sqrt(c * log(available) / rollouts)
+ *
+ * for every child, then the index of the first largest. All arithmetic is in
+ * float so both kernels agree. The log of small counts comes from a table,
+ * and a larger count is only passed to std::log when it differs from the
+ * previous child's, siblings mostly share their available count.
+ */
+class UcbBatch {
+ public:
+  /* Room for any move set, rounded up to whole AVX registers. */
+  static std::size_t constexpr kCapacity =
+      (engine::MoveList::kCapacity + 7u) / 8u * 8u;
+
+  void clear() {
+    mSize = 0u;
+    mLastAvailable = 0u;
+    mLastLog = 0.0f;
+  }
+
+  std::size_t size() const { return mSize; }
+
+  /* aRolloutCount must not be zero. */
+  void push_back(uint32 aRolloutCount, int32 aIntScore, uint32 aAvailable) {
+    ASSERT(mSize < kCapacity && aRolloutCount > 0u);
+
+    if (aAvailable != mLastAvailable) {
+      mLastAvailable = aAvailable;
+      mLastLog = GetLog(aAvailable);
+    }
+    mRolloutCounts[mSize] = static_cast<float>(aRolloutCount);
+    mScores[mSize] = static_cast<float>(aIntScore);
+    mLogAvailable[mSize] = mLastLog;
+    mSize++;
+  }
+
+  float GetValue(std::size_t aIndex, float aFactor, float aExploration) const {
+    return aFactor * mScores[aIndex] / mRolloutCounts[aIndex] +
+           std::sqrt(aExploration * mLogAvailable[aIndex] /
+                     mRolloutCounts[aIndex]);
+  }
+
+  /* Index of the first child with the largest value. Not empty. */
+  template <UcbKernel aKernel = kUcbKernel>
+  std::size_t ArgMax(float aFactor, float aExploration) const {
+    ASSERT(mSize > 0u);
+
+#if defined(__AVX__) || defined(__SSE2__)
+    if constexpr (aKernel == UcbKernel::kSimd) {
+      return ArgMaxSimd(aFactor, aExploration);
+    }
+#endif
+    std::size_t best{0u};
+    float bestValue = std::numeric_limits<float>::lowest();
+    for (std::size_t i = 0u; i < mSize; ++i) {
+      float value = GetValue(i, aFactor, aExploration);
+      if (value > bestValue) {
+        best = i;
+        bestValue = value;
+      }
+    }
+    return best;
+  }
+
+  static float GetLog(uint32 aCount) {
+    if (aCount < kLogTableSize) {
+      return kLogTable[aCount];
+    }
+    return std::log(static_cast<float>(aCount));
+  }
+
+ private:
+  static std::size_t constexpr kLogTableSize = 4096u;
+
+#if defined(__AVX__)
+  /* Each lane keeps the first index of its largest value, lanes past mSize
+   * are forced to minus infinity. */
+  std::size_t ArgMaxSimd(float aFactor, float aExploration) const {
+    static std::size_t constexpr kLanes = 8u;
+
+    __m256 factor = _mm256_set1_ps(aFactor);
+    __m256 exploration = _mm256_set1_ps(aExploration);
+    __m256 size = _mm256_set1_ps(static_cast<float>(mSize));
+    __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 step = _mm256_set1_ps(static_cast<float>(kLanes));
+    __m256 minusInfinity =
+        _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    __m256 best = minusInfinity;
+    __m256 bestLane = lane;
+
+    for (std::size_t i = 0u; i < mSize; i += kLanes) {
+      __m256 rollouts = _mm256_load_ps(&mRolloutCounts[i]);
+      __m256 exploit = _mm256_div_ps(
+          _mm256_mul_ps(factor, _mm256_load_ps(&mScores[i])), rollouts);
+      __m256 explore = _mm256_sqrt_ps(_mm256_div_ps(
+          _mm256_mul_ps(exploration, _mm256_load_ps(&mLogAvailable[i])),
+          rollouts));
+      __m256 value = _mm256_blendv_ps(minusInfinity,
+                                      _mm256_add_ps(exploit, explore),
+                                      _mm256_cmp_ps(lane, size, _CMP_LT_OQ));
+      __m256 greater = _mm256_cmp_ps(value, best, _CMP_GT_OQ);
+      best = _mm256_blendv_ps(best, value, greater);
+      bestLane = _mm256_blendv_ps(bestLane, lane, greater);
+      lane = _mm256_add_ps(lane, step);
+    }
+
+    alignas(32) std::array<float, kLanes> values;
+    alignas(32) std::array<float, kLanes> lanes;
+    _mm256_store_ps(values.data(), best);
+    _mm256_store_ps(lanes.data(), bestLane);
+    return Reduce(values, lanes);
+  }
+#elif defined(__SSE2__)
+  /* Each lane keeps the first index of its largest value, lanes past mSize
+   * are forced to minus infinity. */
+  std::size_t ArgMaxSimd(float aFactor, float aExploration) const {
+    static std::size_t constexpr kLanes = 4u;
+
+    __m128 factor = _mm_set1_ps(aFactor);
+    __m128 exploration = _mm_set1_ps(aExploration);
+    __m128 size = _mm_set1_ps(static_cast<float>(mSize));
+    __m128 lane = _mm_setr_ps(0, 1, 2, 3);
+    __m128 step = _mm_set1_ps(static_cast<float>(kLanes));
+    __m128 minusInfinity = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+    __m128 best = minusInfinity;
+    __m128 bestLane = lane;
+
+    for (std::size_t i = 0u; i < mSize; i += kLanes) {
+      __m128 rollouts = _mm_load_ps(&mRolloutCounts[i]);
+      __m128 exploit =
+          _mm_div_ps(_mm_mul_ps(factor, _mm_load_ps(&mScores[i])), rollouts);
+      __m128 explore = _mm_sqrt_ps(_mm_div_ps(
+          _mm_mul_ps(exploration, _mm_load_ps(&mLogAvailable[i])), rollouts));
+      __m128 value = Blend(minusInfinity, _mm_add_ps(exploit, explore),
+                           _mm_cmplt_ps(lane, size));
+      __m128 greater = _mm_cmpgt_ps(value, best);
+      best = Blend(best, value, greater);
+      bestLane = Blend(bestLane, lane, greater);
+      lane = _mm_add_ps(lane, step);
+    }
+
+    alignas(16) std::array<float, kLanes> values;
+    alignas(16) std::array<float, kLanes> lanes;
+    _mm_store_ps(values.data(), best);
+    _mm_store_ps(lanes.data(), bestLane);
+    return Reduce(values, lanes);
+  }
+
+  /* aMask lanes from aRight, the others from aLeft. */
+  static __m128 Blend(__m128 aLeft, __m128 aRight, __m128 aMask) {
+    return _mm_or_ps(_mm_and_ps(aMask, aRight), _mm_andnot_ps(aMask, aLeft));
+  }
+#endif
+
+  /* The lowest index among the lanes holding the largest value. */
+  template <std::size_t aLanes>
+  static std::size_t Reduce(std::array<float, aLanes> const& aValues,
+                            std::array<float, aLanes> const& aIndices) {
+    std::size_t best{0u};
+    for (std::size_t i = 1u; i < aLanes; ++i) {
+      if (aValues[i] > aValues[best] ||
+          (aValues[i] == aValues[best] && aIndices[i] < aIndices[best])) {
+        best = i;
+      }
+    }
+    return static_cast<std::size_t>(aIndices[best]);
+  }
+
+  static inline std::array<float, kLogTableSize> const kLogTable = [] {
+    std::array<float, kLogTableSize> table{};
+    for (std::size_t i = 1u; i < kLogTableSize; ++i) {
+      table[i] = std::log(static_cast<float>(i));
+    }
+    return table;
+  }();
+
+  alignas(32) std::array<float, kCapacity> mRolloutCounts{};
+  alignas(32) std::array<float, kCapacity> mScores{};
+  alignas(32) std::array<float, kCapacity> mLogAvailable{};
+  std::size_t mSize{0u};
+  uint32 mLastAvailable{0u};
+  float mLastLog{0.0f};
+};
+
+}  // namespace agent
+
+#endif  // AGENT_UCBBATCH_HPP
@@ -0,0 +1,217 @@
+#ifndef ENGINE_CARDTABLE_HPP
+#define ENGINE_CARDTABLE_HPP
+
+#include <array>
+
+#include "engine_Gemset.hpp"
+#include "util_General.hpp"
+
+namespace engine {
+
+/* Everything about a development card that is known at compile time. */
+struct DevelopmentCardInfo {
+  Gemset mCost{};
+  /* Bit i set when noble i asks for the card's color. */
+  uint16 mNobles{0u};
+  Color mColor{};
+  uint8 mPoints{0u};
+  uint8 mLevel{0xFFu};
+  uint8 mCostCount{0u};
+};
+
+struct NobleCardInfo {
+  Gemset mCost{};
+  uint8 mPoints{3u};
+};
+
+/**
+ * Every development card and noble in one flat table each, built at compile
+ * time. The development card table is indexed by the 7 bit index
+ * DevelopmentCard stores, hidden and invalid indices included, so looking up
+ * a card is a single load.
+ */
+class CardTable {
+ public:
+  static std::size_t constexpr kLevelCount = 3u;
+  static std::array<std::size_t, kLevelCount> constexpr kLevelCardCount{
+      40u, 30u, 20u};
+  static std::size_t constexpr kDevelopmentCardCount = 90u;
+  static std::size_t constexpr kNobleCardCount = 10u;
+  /* Indices of the hidden card of each level, then of the invalid card. */
+  static uint8 constexpr kHiddenIndex = 124u;
+  static uint8 constexpr kInvalidIndex = kHiddenIndex + kLevelCount;
+  static std::size_t constexpr kIndexCount = kInvalidIndex + 1u;
+
+  static DevelopmentCardInfo const& GetDevelopmentCard(uint8 aIndex) {
+    return kDevelopmentCards[aIndex];
+  }
+  static NobleCardInfo const& GetNobleCard(uint8 aIndex) {
+    return kNobleCards[aIndex];
+  }
+
+ private:
+  struct Card {
+    Color mColor;
+    uint8 mPoints;
+    Gemset mCost;
+  };
+
+  static constexpr std::array<Card, kDevelopmentCardCount> kCards{{
+      {Color::kBlack, 0, Gemset(1, 1, 1, 1, 0)},
+      {Color::kBlack, 0, Gemset(1, 2, 1, 1, 0)},
+      {Color::kBlack, 0, Gemset(2, 2, 0, 1, 0)},
+      {Color::kBlack, 0, Gemset(0, 0, 1, 3, 1)},
+      {Color::kBlack, 0, Gemset(0, 0, 2, 1, 0)},
+      {Color::kBlack, 0, Gemset(2, 0, 2, 0, 0)},
+      {Color::kBlack, 0, Gemset(0, 0, 3, 0, 0)},
+      {Color::kBlack, 1, Gemset(0, 4, 0, 0, 0)},
+      {Color::kBlue, 0, Gemset(1, 0, 1, 1, 1)},
+      {Color::kBlue, 0, Gemset(1, 0, 1, 2, 1)},
+      {Color::kBlue, 0, Gemset(1, 0, 2, 2, 0)},
+      {Color::kBlue, 0, Gemset(0, 1, 3, 1, 0)},
+      {Color::kBlue, 0, Gemset(1, 0, 0, 0, 2)},
+      {Color::kBlue, 0, Gemset(0, 0, 2, 0, 2)},
+      {Color::kBlue, 0, Gemset(0, 0, 0, 0, 3)},
+      {Color::kBlue, 1, Gemset(0, 0, 0, 4, 0)},
+      {Color::kWhite, 0, Gemset(0, 1, 1, 1, 1)},
+      {Color::kWhite, 0, Gemset(0, 1, 2, 1, 1)},
+      {Color::kWhite, 0, Gemset(0, 2, 2, 0, 1)},
+      {Color::kWhite, 0, Gemset(3, 1, 0, 0, 1)},
+      {Color::kWhite, 0, Gemset(0, 0, 0, 2, 1)},
+      {Color::kWhite, 0, Gemset(0, 2, 0, 0, 2)},
+      {Color::kWhite, 0, Gemset(0, 3, 0, 0, 0)},
+      {Color::kWhite, 1, Gemset(0, 0, 4, 0, 0)},
+      {Color::kGreen, 0, Gemset(1, 1, 0, 1, 1)},
+      {Color::kGreen, 0, Gemset(1, 1, 0, 1, 2)},
+      {Color::kGreen, 0, Gemset(0, 1, 0, 2, 2)},
+      {Color::kGreen, 0, Gemset(1, 3, 1, 0, 0)},
+      {Color::kGreen, 0, Gemset(2, 1, 0, 0, 0)},
+      {Color::kGreen, 0, Gemset(0, 2, 0, 2, 0)},
+      {Color::kGreen, 0, Gemset(0, 0, 0, 3, 0)},
+      {Color::kGreen, 1, Gemset(0, 0, 0, 0, 4)},
+      {Color::kRed, 0, Gemset(1, 1, 1, 0, 1)},
+      {Color::kRed, 0, Gemset(2, 1, 1, 0, 1)},
+      {Color::kRed, 0, Gemset(2, 0, 1, 0, 2)},
+      {Color::kRed, 0, Gemset(1, 0, 0, 1, 3)},
+      {Color::kRed, 0, Gemset(0, 2, 1, 0, 0)},
+      {Color::kRed, 0, Gemset(2, 0, 0, 2, 0)},
+      {Color::kRed, 0, Gemset(3, 0, 0, 0, 0)},
+      {Color::kRed, 1, Gemset(4, 0, 0, 0, 0)},
+      {Color::kBlack, 1, Gemset(3, 2, 2, 0, 0)},
+      {Color::kBlack, 1, Gemset(3, 0, 3, 0, 2)},
+      {Color::kBlack, 2, Gemset(0, 1, 4, 2, 0)},
+      {Color::kBlack, 2, Gemset(0, 0, 5, 3, 0)},
+      {Color::kBlack, 2, Gemset(5, 0, 0, 0, 0)},
+      {Color::kBlack, 3, Gemset(0, 0, 0, 0, 6)},
+      {Color::kBlue, 1, Gemset(0, 2, 2, 3, 0)},
+      {Color::kBlue, 1, Gemset(0, 2, 3, 0, 3)},
+      {Color::kBlue, 2, Gemset(5, 3, 0, 0, 0)},
+      {Color::kBlue, 2, Gemset(2, 0, 0, 1, 4)},
+      {Color::kBlue, 2, Gemset(0, 5, 0, 0, 0)},
+      {Color::kBlue, 3, Gemset(0, 6, 0, 0, 0)},
+      {Color::kWhite, 1, Gemset(0, 0, 3, 2, 2)},
+      {Color::kWhite, 1, Gemset(2, 3, 0, 3, 0)},
+      {Color::kWhite, 2, Gemset(0, 0, 1, 4, 2)},
+      {Color::kWhite, 2, Gemset(0, 0, 0, 5, 3)},
+      {Color::kWhite, 2, Gemset(0, 0, 0, 5, 0)},
+      {Color::kWhite, 3, Gemset(6, 0, 0, 0, 0)},
+      {Color::kGreen, 1, Gemset(3, 0, 2, 3, 0)},
+      {Color::kGreen, 1, Gemset(2, 3, 0, 0, 2)},
+      {Color::kGreen, 2, Gemset(4, 2, 0, 0, 1)},
+      {Color::kGreen, 2, Gemset(0, 5, 3, 0, 0)},
+      {Color::kGreen, 2, Gemset(0, 0, 5, 0, 0)},
+      {Color::kGreen, 3, Gemset(0, 0, 6, 0, 0)},
+      {Color::kRed, 1, Gemset(2, 0, 0, 2, 3)},
+      {Color::kRed, 1, Gemset(0, 3, 0, 2, 3)},
+      {Color::kRed, 2, Gemset(1, 4, 2, 0, 0)},
+      {Color::kRed, 2, Gemset(3, 0, 0, 0, 5)},
+      {Color::kRed, 2, Gemset(0, 0, 0, 0, 5)},
+      {Color::kRed, 3, Gemset(0, 0, 0, 6, 0)},
+      {Color::kBlack, 3, Gemset(3, 3, 5, 3, 0)},
+      {Color::kBlack, 4, Gemset(0, 0, 0, 7, 0)},
+      {Color::kBlack, 4, Gemset(0, 0, 3, 6, 3)},
+      {Color::kBlack, 5, Gemset(0, 0, 0, 7, 3)},
+      {Color::kBlue, 3, Gemset(3, 0, 3, 3, 5)},
+      {Color::kBlue, 4, Gemset(7, 0, 0, 0, 0)},
+      {Color::kBlue, 4, Gemset(6, 3, 0, 0, 3)},
+      {Color::kBlue, 5, Gemset(7, 3, 0, 0, 0)},
+      {Color::kWhite, 3, Gemset(0, 3, 3, 5, 3)},
+      {Color::kWhite, 4, Gemset(0, 0, 0, 0, 7)},
+      {Color::kWhite, 4, Gemset(3, 0, 0, 3, 6)},
+      {Color::kWhite, 5, Gemset(3, 0, 0, 0, 7)},
+      {Color::kGreen, 3, Gemset(5, 3, 0, 3, 3)},
+      {Color::kGreen, 4, Gemset(0, 7, 0, 0, 0)},
+      {Color::kGreen, 4, Gemset(3, 6, 3, 0, 0)},
+      {Color::kGreen, 5, Gemset(0, 7, 3, 0, 0)},
+      {Color::kRed, 3, Gemset(3, 5, 3, 0, 3)},
+      {Color::kRed, 4, Gemset(0, 0, 7, 0, 0)},
+      {Color::kRed, 4, Gemset(0, 3, 6, 3, 0)},
+      {Color::kRed, 5, Gemset(0, 0, 7, 3, 0)},
+  }};
+
+  static constexpr std::array<Gemset, kNobleCardCount> kNobleCosts{{
+      Gemset(4, 4, 0, 0, 0),
+      Gemset(0, 4, 4, 0, 0),
+      Gemset(0, 0, 4, 4, 0),
+      Gemset(0, 0, 0, 4, 4),
+      Gemset(4, 0, 0, 0, 4),
+      Gemset(3, 3, 3, 0, 0),
+      Gemset(0, 3, 3, 3, 0),
+      Gemset(0, 0, 3, 3, 3),
+      Gemset(3, 0, 0, 3, 3),
+      Gemset(3, 3, 0, 0, 3),
+  }};
+
+  static constexpr std::array<DevelopmentCardInfo, kIndexCount>
+  MakeDevelopmentCards() {
+    std::array<DevelopmentCardInfo, kIndexCount> table{};
+
+    std::size_t index{0u};
+    for (std::size_t level = 0u; level < kLevelCount; ++level) {
+      for (std::size_t i = 0u; i < kLevelCardCount[level]; ++i, ++index) {
+        auto const& card = kCards[index];
+        auto& info = table[index];
+        info.mCost = card.mCost;
+        info.mColor = card.mColor;
+        info.mPoints = card.mPoints;
+        info.mLevel = level;
+        info.mCostCount = card.mCost.GetCount();
+        for (std::size_t noble = 0u; noble < kNobleCardCount; ++noble) {
+          if (kNobleCosts[noble].Get(card.mColor) > 0u) {
+            info.mNobles |= 1u << noble;
+          }
+        }
+      }
+    }
+
+    for (std::size_t level = 0u; level < kLevelCount; ++level) {
+      table[kHiddenIndex + level].mLevel = level;
+    }
+
+    return table;
+  }
+
+  static constexpr std::array<NobleCardInfo, kNobleCardCount> MakeNobleCards() {
+    std::array<NobleCardInfo, kNobleCardCount> table{};
+    for (std::size_t i = 0u; i < kNobleCardCount; ++i) {
+      table[i].mCost = kNobleCosts[i];
+    }
+    return table;
+  }
+
+  alignas(64) static std::array<DevelopmentCardInfo, kIndexCount> const
+      kDevelopmentCards;
+  alignas(64) static std::array<NobleCardInfo, kNobleCardCount> const
+      kNobleCards;
+};
+
+alignas(64) inline constexpr std::array<DevelopmentCardInfo,
+                                        CardTable::kIndexCount>
+    CardTable::kDevelopmentCards = MakeDevelopmentCards();
+alignas(64) inline constexpr std::array<NobleCardInfo,
+                                        CardTable::kNobleCardCount>
+    CardTable::kNobleCards = MakeNobleCards();
+
+}  // namespace engine
+
+#endif  // ENGINE_CARDTABLE_HPP
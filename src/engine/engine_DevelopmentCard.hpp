@@ -2,10 +2,13 @@
 #define ENGINE_DEVELOPMENTCARD_HPP
 
 #include <array>
+#include <bit>
 #include <iostream>
 #include <limits>
+#include <span>
 #include <type_traits>
 
+#include "engine_CardTable.hpp"
 #include "engine_Gemset.hpp"
 #include "util_General.hpp"
 
@@ -15,64 +18,27 @@ class DevelopmentCard {
  public:
   DevelopmentCard() = default;
 
-  Gemset const& GetCost() const { return Resolve()->GetCost(); }
-  Color GetColor() const { return Resolve()->GetColor(); }
-  size_t GetPoints() const { return Resolve()->GetPoints(); }
-  uint8 GetLevel() const {
-    if (IsHidden()) {
-      switch (GetIndex()) {
-        case kHiddenLevel0:
-          return 0;
-        case kHiddenLevel1:
-          return 1;
-        case kHiddenLevel2:
-          return 2;
-        default:
-          ASSERT_ALWAYS();
-          return 0xFF;
-      }
-    }
-
-    if (GetIndex() < kLevel0.size()) {
-      return 0u;
-    }
-
-    if (GetIndex() - kLevel0.size() < kLevel1.size()) {
-      return 1u;
-    }
-
-    if (GetIndex() - kLevel0.size() - kLevel1.size() < kLevel2.size()) {
-      return 2u;
-    }
-
-    ASSERT_ALWAYS();
-    return 0xFF;
-  }
+  Gemset const& GetCost() const { return Resolve().mCost; }
+  Color GetColor() const { return Resolve().mColor; }
+  size_t GetPoints() const { return Resolve().mPoints; }
+  uint8 GetLevel() const { return Resolve().mLevel; }
+  /* Gems in GetCost(). */
+  uint8 GetCostCount() const { return Resolve().mCostCount; }
+  /* Bit i set when noble i asks for GetColor(). */
+  uint16 GetNobles() const { return Resolve().mNobles; }
 
   operator bool() const { return IsValid(); }
   bool IsValid() const { return GetIndex() != kInvalidDevelopmentCard; }
   void Reset() { mIndex = kInvalidDevelopmentCard; }
 
   bool IsHidden() const {
-    return (GetIndex() == kHiddenLevel0 || GetIndex() == kHiddenLevel1 ||
-            GetIndex() == kHiddenLevel2);
+    return static_cast<uint8>(GetIndex() - kHiddenLevel0) <
+           CardTable::kLevelCount;
   }
   DevelopmentCard SetHidden() {
     auto card = *this;
-    switch (GetLevel()) {
-      case 0:
-        SetIndex(kHiddenLevel0);
-        break;
-      case 1:
-        SetIndex(kHiddenLevel1);
-        break;
-      case 2:
-        SetIndex(kHiddenLevel2);
-        break;
-      default:
-        ASSERT_ALWAYS();
-        break;
-    }
+    ASSERT(GetLevel() < CardTable::kLevelCount);
+    SetIndex(kHiddenLevel0 + GetLevel());
     return card;
   }
   void ClearHidden(DevelopmentCard const& aCard) { SetIndex(aCard.GetIndex()); }
@@ -98,41 +64,10 @@ class DevelopmentCard {
   uint8 GetIndex() const { return mIndex & kIndexBits; }
 
  private:
-  class Internal {
-   public:
-    Internal(Color aColor, uint8 aPoints, Gemset const& aCost)
-        : mCost{aCost}, mPoints{aPoints}, mColor{aColor} {}
-
-    Gemset const& GetCost() const { return mCost; }
-    Color GetColor() const { return mColor; }
-    size_t GetPoints() const { return mPoints; }
-
-   private:
-    Gemset mCost;
-    uint8 mPoints;
-    Color mColor;
-  };
-
-  static Internal const* ResolveCard(uint8 aIndex) {
-    if (aIndex < kLevel0.size()) {
-      return &kLevel0[aIndex];
-    }
-    aIndex -= kLevel0.size();
-
-    if (aIndex < kLevel1.size()) {
-      return &kLevel1[aIndex];
-    }
-    aIndex -= kLevel1.size();
-
-    if (aIndex < kLevel2.size()) {
-      return &kLevel2[aIndex];
-    }
-
-    return nullptr;
+  DevelopmentCardInfo const& Resolve() const {
+    return CardTable::GetDevelopmentCard(GetIndex());
   }
 
-  Internal const* Resolve() const { return ResolveCard(GetIndex()); }
-
   void SetIndex(uint8 aIndex) {
     ASSERT(aIndex <= kIndexBits);
     mIndex &= kRevealedBit;
@@ -141,16 +76,15 @@ class DevelopmentCard {
 
   uint8 mIndex{kInvalidDevelopmentCard};
 
-  static std::array<Internal, 40> const kLevel0;
-  static std::array<Internal, 30> const kLevel1;
-  static std::array<Internal, 20> const kLevel2;
-
   static uint8 constexpr kRevealedBit = 0b10000000;
   static uint8 constexpr kIndexBits = static_cast<uint8>(~kRevealedBit);
   static uint8 constexpr kInvalidDevelopmentCard{kIndexBits};
   static uint8 constexpr kHiddenLevel2 = kInvalidDevelopmentCard - 1u;
   static uint8 constexpr kHiddenLevel1 = kHiddenLevel2 - 1u;
   static uint8 constexpr kHiddenLevel0 = kHiddenLevel1 - 1u;
+
+  static_assert(kInvalidDevelopmentCard == CardTable::kInvalidIndex);
+  static_assert(kHiddenLevel0 == CardTable::kHiddenIndex);
 };
 
 static std::size_t constexpr kDevelopmentCardLevelCount = 3u;
@@ -165,20 +99,28 @@ class Deck {
   }
 
   DevelopmentCard Draw(util::Generator& aGenerator) {
-    if (mCards == 0u) {
-      return DevelopmentCard{};
-    }
-
-    std::array<uint8, aDeckSize> cards{};
-    uint8 top{0u};
-    util::IterateBitfield(mCards,
-                          [&](std::size_t aIndex) { cards[top++] = aIndex; });
-
-    auto index = cards[aGenerator() % top];
+    DevelopmentCard card{};
+    DrawMany({&card, 1u}, aGenerator);
+    return card;
+  }
 
-    mCards &= ~(1ul << index);
+  /* Fills aCards with distinct cards, uniformly at random, and invalid cards
+   * once the deck runs out. Picks the rank of the card among those left and
+   * selects that set bit, so nothing is enumerated. */
+  void DrawMany(std::span<DevelopmentCard> aCards,
+                util::Generator& aGenerator) {
+    auto count = static_cast<std::size_t>(std::popcount(mCards));
+    for (auto& card : aCards) {
+      if (count == 0u) {
+        card = DevelopmentCard{};
+        continue;
+      }
 
-    return DevelopmentCard{static_cast<uint8>(aOffset + index)};
+      auto rank = util::Uniform(aGenerator, count--);
+      auto index = util::SelectBit(mCards, rank);
+      mCards &= ~(StorageType{1u} << index);
+      card = DevelopmentCard{static_cast<uint8>(aOffset + index)};
+    }
   }
 
   void Insert(DevelopmentCard const& aCard) {
@@ -217,6 +159,22 @@ struct Decks {
     return DevelopmentCard{};
   }
 
+  void DrawMany(uint8 aLevel, std::span<DevelopmentCard> aCards,
+                util::Generator& aGenerator) {
+    switch (aLevel) {
+      case 0:
+        return mLevel0.DrawMany(aCards, aGenerator);
+      case 1:
+        return mLevel1.DrawMany(aCards, aGenerator);
+      case 2:
+        return mLevel2.DrawMany(aCards, aGenerator);
+      default:
+        break;
+    }
+
+    ASSERT_ALWAYS();
+  }
+
   void Insert(DevelopmentCard const& aCard) {
     switch (aCard.GetLevel()) {
       case 0:
@@ -3,6 +3,8 @@
 #include <algorithm>
 
 #include "engine_Move.hpp"
+#include "engine_MoveList.hpp"
+#include "engine_MoveTable.hpp"
 
 namespace engine {
 
@@ -14,31 +16,41 @@ GameState::GameState(Generator& aGenerator) {
   }
 
   mNobles = NobleCard::ShuffleNobles(aGenerator);
-  mNextPlayer = aGenerator() % mPlayers.size();
+  mNextPlayer = util::Uniform(aGenerator, mPlayers.size());
+  mHash = ComputeHash();
+}
+
+uint64 GameState::ComputeHash() const {
+  static_assert(offsetof(GameState, mHash) == kHashedWordCount * kWordSize);
+  return HashWords(0u, kHashedWordCount);
 }
 
 std::vector<Move> GameState::GetMoves() const {
+  MoveList moves{};
+  GetMoves(moves);
+  return std::vector<Move>(moves.begin(), moves.end());
+}
+
+void GameState::GetMoves(MoveList& aMoves) const {
   ASSERT(mDeterminized);
 
+  aMoves.clear();
+
   if (IsTerminal()) {
-    return std::vector<Move>();
+    return;
   }
 
-  std::vector<Move> moves{};
-  moves.reserve(45u);
-
-  if (GetPlayer().GetPhase() == Player::TurnPhase::kReturn) {
-    GetReturnMoves(moves);
-  } else if (GetPlayer().GetPhase() == Player::TurnPhase::kNoble) {
-    GetNobleMoves(moves);
+  if (mPhase == TurnPhase::kReturn) {
+    GetReturnMoves(aMoves);
+  } else if (mPhase == TurnPhase::kNoble) {
+    GetNobleMoves(aMoves);
   } else {
-    GetCollectMoves(moves);
-    GetPurchaseMoves(moves);
-    GetReserveMoves(moves);
+    GetCollectMoves(aMoves);
+    GetPurchaseMoves(aMoves);
+    GetReserveMoves(aMoves);
   }
 
-  ASSERT(moves.size() > 0);
-  return moves;
+  ASSERT(aMoves.size() > 0);
 }
 
 std::optional<uint8> GameState::GetWinner() const {
@@ -68,11 +80,11 @@ std::optional<uint8> GameState::GetWinner() const {
 }
 
 bool GameState::IsTerminal() const {
-  if (mPlayers.front().GetTurnCount() != mPlayers.back().GetTurnCount()) {
+  if (mTurnCount % mPlayers.size() != 0u) {
     return false;
   }
 
-  if (mPlayers.front().GetTurnCount() > kMaxTurnCount) {
+  if (mTurnCount / mPlayers.size() > kMaxTurnCount) {
     return true;
   }
 
@@ -112,27 +124,33 @@ void GameState::DoMove(Move const& aMove, Generator& aGenerator) {
       break;
   }
 
+  EndMove();
+  VerifyHash();
+}
+
+void GameState::EndMove() {
+  Rehash rehash{*this, mNextPlayer, mTurnCount};
   bool endTurn = false;
   auto& player = GetPlayer();
 
-  switch (player.GetPhase()) {
-    case Player::TurnPhase::kAction:
+  switch (mPhase) {
+    case TurnPhase::kAction:
       if (player.GetGemCount() > kMaxGemCount) {
-        player.SetPhase(Player::TurnPhase::kReturn);
+        mPhase = TurnPhase::kReturn;
       } else if (HasNobleMoves()) {
-        player.SetPhase(Player::TurnPhase::kNoble);
+        mPhase = TurnPhase::kNoble;
       } else {
         endTurn = true;
       }
       break;
-    case Player::TurnPhase::kReturn:
+    case TurnPhase::kReturn:
       if (HasNobleMoves()) {
-        player.SetPhase(Player::TurnPhase::kNoble);
+        mPhase = TurnPhase::kNoble;
       } else {
         endTurn = true;
       }
       break;
-    case Player::TurnPhase::kNoble:
+    case TurnPhase::kNoble:
       endTurn = true;
       break;
     default:
@@ -141,12 +159,18 @@ void GameState::DoMove(Move const& aMove, Generator& aGenerator) {
   }
 
   if (endTurn) {
-    player.SetPhase(Player::TurnPhase::kAction);
-    player.AddTurn();
+    mPhase = TurnPhase::kAction;
+    mTurnCount++;
     mNextPlayer = 1 - mNextPlayer;
   }
 }
 
+void GameState::VerifyHash() const {
+  if constexpr (kVerifyHash) {
+    ASSERT(mHash == ComputeHash());
+  }
+}
+
 void GameState::DoCollectMove(Gemset const& aTake) {
   ASSERT(aTake.GetCount() <= 3);
 
@@ -158,8 +182,10 @@ void GameState::DoCollectMove(Gemset const& aTake) {
     ASSERT(aTake.Get(i) <= mAvailable.Get(i));
   }
 
-  GetPlayer().AddGems(aTake);
+  Rehash available{*this, mAvailable};
+  Rehash player{*this, GetPlayer()};
   mAvailable = Gemset::Sub(mAvailable, aTake);
+  GetPlayer().AddGems(aTake);
 }
 
 void GameState::DoPurchaseMove(DevelopmentCard const& aCard,
@@ -181,6 +207,7 @@ void GameState::DoPurchaseMove(DevelopmentCard const& aCard,
     auto const& reserved = player.GetReservedDevelopmentCards();
     for (std::size_t index = 0u; index < reserved.size(); ++index) {
       if (reserved[index] == aCard) {
+        Rehash rehash{*this, player};
         player.RemoveDevelopmentCard(index);
         found = true;
         break;
@@ -190,6 +217,8 @@ void GameState::DoPurchaseMove(DevelopmentCard const& aCard,
 
   ASSERT(found);
 
+  Rehash available{*this, mAvailable};
+  Rehash rehash{*this, player};
   auto goldDemand = Gemset::GetGoldDemand(player.GetDiscount(),
                                           player.GetHeld(), aCard.GetCost());
   ASSERT(goldDemand <= player.GetGold());
@@ -210,10 +239,8 @@ void GameState::DoPurchaseMove(DevelopmentCard const& aCard,
     }
   }
 
-  mAvailable = Gemset::Add(mAvailable, spend);
-  mGold += goldDemand;
-  ASSERT(mGold <= 5u);
   player.RemoveGems(spend);
+  mAvailable = Gemset::Add(mAvailable, spend);
   player.RemoveGold(goldDemand);
 
   player.AddDiscount(aCard.GetColor());
@@ -237,21 +264,27 @@ void GameState::DoReserveFaceUpMove(DevelopmentCard const& aCard,
 }
 
 void GameState::DoReserveFaceDownMove(uint8 aLevel, Generator& aGenerator) {
-  auto card = mDecks.Draw(aLevel, aGenerator);
+  DevelopmentCard card{};
+  {
+    Rehash rehash{*this, mDecks};
+    card = mDecks.Draw(aLevel, aGenerator);
+  }
   ASSERT(card);
   bool revealed = false;
   DoReserveMove(card, revealed);
 }
 
 void GameState::DoReserveMove(DevelopmentCard const& aCard, bool aRevealed) {
+  Rehash rehash{*this, GetPlayer()};
   GetPlayer().AddDevelopmentCard(aCard, aRevealed);
-  if (mGold > 0) {
+  if (GetAvailableGold() > 0) {
     GetPlayer().AddGold(1u);
-    mGold--;
   }
 }
 
 void GameState::DoNobleMove(NobleCard const& aNoble) {
+  Rehash nobles{*this, mNobles};
+  Rehash player{*this, GetPlayer()};
   for (auto& noble : mNobles) {
     if (noble == aNoble) {
       noble.Reset();
@@ -260,20 +293,23 @@ void GameState::DoNobleMove(NobleCard const& aNoble) {
 
   GetPlayer().AddPoints(aNoble.GetPoints());
 
-  ASSERT(Gemset::GetGoldDemand(GetPlayer().GetDiscount(), Gemset(),
-                               aNoble.GetCost()) == 0);
+  ASSERT(Gemset::Covers(GetPlayer().GetDiscount(), aNoble.GetCost()));
 }
 
 void GameState::DoReturnMove(Gemset const& aGive) {
   for (std::size_t i = 0; i < kGemColorCount; ++i) {
     ASSERT(GetPlayer().GetHeld().Get(i) >= aGive.Get(i));
   }
+  Rehash available{*this, mAvailable};
+  Rehash player{*this, GetPlayer()};
   GetPlayer().RemoveGems(aGive);
   mAvailable = Gemset::Add(mAvailable, aGive);
 }
 
 DevelopmentCard GameState::ReplaceCard(uint8 aLevel, uint8 aIndex,
                                        Generator& aGenerator) {
+  Rehash decks{*this, mDecks};
+  Rehash slot{*this, mRevealed[aLevel][aIndex]};
   auto card = mRevealed[aLevel][aIndex];
   auto next = mDecks.Draw(aLevel, aGenerator);
   next.SetRevealed(true);
@@ -285,42 +321,20 @@ DevelopmentCard GameState::ReplaceCard(uint8 aLevel, uint8 aIndex,
   return card;
 }
 
-void GameState::GetReturnMoves(std::vector<Move>& aMoves) const {
+void GameState::GetReturnMoves(MoveList& aMoves) const {
   std::size_t toReturnCount = GetPlayer().GetGemCount() - kMaxGemCount;
   ASSERT(toReturnCount > 0);
 
-  std::size_t W = GetPlayer().GetHeld().Get(Color::kWhite);
-  std::size_t U = GetPlayer().GetHeld().Get(Color::kBlue);
-  std::size_t G = GetPlayer().GetHeld().Get(Color::kGreen);
-  std::size_t R = GetPlayer().GetHeld().Get(Color::kRed);
-  std::size_t B = GetPlayer().GetHeld().Get(Color::kBlack);
-
-  for (std::size_t w = 0u; w <= std::min(W, toReturnCount); ++w) {
-    for (std::size_t u = 0u; u <= std::min(U, toReturnCount - w); ++u) {
-      for (std::size_t g = 0u; g <= std::min(G, toReturnCount - w - u); ++g) {
-        for (std::size_t r = 0u; r <= std::min(R, toReturnCount - w - u - g);
-             ++r) {
-          for (std::size_t b = 0u;
-               b <= std::min(B, toReturnCount - w - u - g - r); ++b) {
-            if (w + u + g + r + b == toReturnCount) {
-              aMoves.emplace_back(Move::MakeReturnMove(Gemset(w, u, g, r, b)));
-            }
-          }
-        }
-      }
-    }
-  }
+  MoveTable::GetReturnMoves(GetPlayer().GetHeld(), toReturnCount, aMoves);
 }
 
-std::size_t GameState::GetNobleMoves(std::vector<Move>* aMoves) const {
+std::size_t GameState::GetNobleMoves(MoveList* aMoves) const {
   std::size_t moveCount{0};
   std::size_t index{0};
 
   for (auto noble : mNobles) {
     if (noble) {
-      std::size_t goldRequired = Gemset::GetGoldDemand(
-          GetPlayer().GetDiscount(), Gemset(), noble.GetCost());
-      if (goldRequired == 0) {
+      if (Gemset::Covers(GetPlayer().GetDiscount(), noble.GetCost())) {
         if (aMoves) {
           aMoves->push_back(Move::MakeNobleMove(noble));
         }
@@ -334,83 +348,56 @@ std::size_t GameState::GetNobleMoves(std::vector<Move>* aMoves) const {
   return moveCount;
 }
 
-void GameState::GetCollectMoves(std::vector<Move>& aMoves) const {
-  std::size_t maxCollectCount{0u};
-  for (size_t i = 0u; i < kGemColorCount; ++i) {
-    if (mAvailable.Get(i) > 0) {
-      maxCollectCount++;
-    }
-  }
-  maxCollectCount = std::min(maxCollectCount, kMaxCollectCount);
+void GameState::GetCollectMoves(MoveList& aMoves) const {
+  aMoves.append(MoveTable::GetCollectMoves(MoveTable::GetColorMask(
+      mAvailable, [](std::size_t aCount) { return aCount > 0u; })));
+  aMoves.append(MoveTable::GetCollectTwoMoves(MoveTable::GetColorMask(
+      mAvailable, [](std::size_t aCount) { return aCount >= 4u; })));
+}
 
-  GetCollectMoves(aMoves, maxCollectCount);
+void GameState::GetPurchaseMoves(MoveList& aMoves) const {
+  PurchaseArray<DevelopmentCard> cards{};
+  PurchaseArray<Gemset> costs{};
+  PurchaseArray<Gemset> missing{};
+  uint32 candidates = GetPurchaseCandidates(cards, costs);
 
-  for (std::size_t i = 0u; i < kGemColorCount; ++i) {
-    if (mAvailable.Get(i) >= 4) {
-      Gemset take{};
-      take.Set(i, 2u);
-      aMoves.emplace_back(Move::MakeCollectMove(take));
-    }
-  }
-}
+  auto const& player = GetPlayer();
+  auto power = Gemset::Add(player.GetDiscount(), player.GetHeld());
+  candidates &= Gemset::GetAffordableMask(power, player.GetGold(), costs,
+                                          missing);
 
-void GameState::GetCollectMoves(std::vector<Move>& aMoves,
-                                std::size_t aMaxCollectCount) const {
-  std::size_t W = std::min(1ul, mAvailable.Get(Color::kWhite));
-  std::size_t U = std::min(1ul, mAvailable.Get(Color::kBlue));
-  std::size_t G = std::min(1ul, mAvailable.Get(Color::kGreen));
-  std::size_t R = std::min(1ul, mAvailable.Get(Color::kRed));
-  std::size_t B = std::min(1ul, mAvailable.Get(Color::kBlack));
-
-  for (std::size_t w = 0u; w <= std::min(W, aMaxCollectCount); ++w) {
-    for (std::size_t u = 0u; u <= std::min(U, aMaxCollectCount - w); ++u) {
-      for (std::size_t g = 0u; g <= std::min(G, aMaxCollectCount - w - u);
-           ++g) {
-        for (std::size_t r = 0u; r <= std::min(R, aMaxCollectCount - w - u - g);
-             ++r) {
-          for (std::size_t b = 0u;
-               b <= std::min(B, aMaxCollectCount - w - u - g - r); ++b) {
-            if (w + u + g + r + b == aMaxCollectCount) {
-              aMoves.emplace_back(Move::MakeCollectMove(Gemset(w, u, g, r, b)));
-            }
-          }
-        }
-      }
-    }
-  }
+  util::IterateBitfield(candidates, [&](std::size_t aIndex) {
+    aMoves.emplace_back(Move::MakePurchaseMove(cards[aIndex]));
+  });
 }
 
-void GameState::GetPurchaseMoves(std::vector<Move>& aMoves) const {
-  for (std::size_t level = 0u; level < mRevealed.size(); ++level) {
-    for (std::size_t index = 0u; index < mRevealed[level].size(); ++index) {
-      auto card = mRevealed[level][index];
-      if (card) {
-        TryAddPurchaseMove(aMoves, card);
-      }
+uint32 GameState::GetPurchaseCandidates(PurchaseArray<DevelopmentCard>& aCards,
+                                        PurchaseArray<Gemset>& aCosts) const {
+  uint32 candidates{0u};
+  std::size_t slot{0u};
+  auto addCandidate = [&](DevelopmentCard const& aCard) {
+    if (aCard) {
+      aCards[slot] = aCard;
+      aCosts[slot] = aCard.GetCost();
+      candidates |= 1u << slot;
     }
-  }
+    slot++;
+  };
 
-  auto const& reserved = GetPlayer().GetReservedDevelopmentCards();
-  for (std::size_t index = 0u; index < reserved.size(); ++index) {
-    auto card = reserved[index];
-    if (card) {
-      TryAddPurchaseMove(aMoves, card);
+  for (auto const& row : mRevealed) {
+    for (auto const& card : row) {
+      addCandidate(card);
     }
   }
-}
-
-void GameState::TryAddPurchaseMove(std::vector<Move>& aMoves,
-                                   DevelopmentCard const& aCard) const {
-  std::size_t goldRequired = Gemset::GetGoldDemand(
-      GetPlayer().GetDiscount(), GetPlayer().GetHeld(), aCard.GetCost());
-  if (goldRequired > GetPlayer().GetGold()) {
-    return;
+  for (auto const& card : GetPlayer().GetReservedDevelopmentCards()) {
+    addCandidate(card);
   }
+  ASSERT(slot < kPurchaseCandidateCount);
 
-  aMoves.emplace_back(Move::MakePurchaseMove(aCard));
+  return candidates;
 }
 
-void GameState::GetReserveMoves(std::vector<Move>& aMoves) const {
+void GameState::GetReserveMoves(MoveList& aMoves) const {
   auto const& reserved = GetPlayer().GetReservedDevelopmentCards();
   if (reserved[0] && reserved[1] && reserved[2]) {
     // Player's hand is full.
@@ -435,33 +422,84 @@ void GameState::GetReserveMoves(std::vector<Move>& aMoves) const {
 
 // Set hidden info to plausible state.
 void GameState::Determinize(Generator& aGenerator) {
+  // Two players with three reserved slots each.
+  static std::size_t constexpr kMaxHiddenCount{6u};
+
+  // Hidden slots grouped by level, so each deck is drawn from once.
+  std::array<std::array<DevelopmentCard*, kMaxHiddenCount>,
+             kDevelopmentCardLevelCount>
+      hidden{};
+  std::array<std::size_t, kDevelopmentCardLevelCount> hiddenCounts{};
   for (auto& player : mPlayers) {
     for (auto& slot : player.GetReservedDevelopmentCards()) {
       if (slot && slot.IsHidden()) {
-        slot.ClearHidden(mDecks.Draw(slot.GetLevel(), aGenerator));
+        auto level = slot.GetLevel();
+        hidden[level][hiddenCounts[level]++] = &slot;
       }
     }
   }
 
-  mDeterminized = true;
+  std::size_t hiddenCount = hiddenCounts[0] + hiddenCounts[1] + hiddenCounts[2];
+  if (hiddenCount > 0u) {
+    Rehash decks{*this, mDecks};
+    Rehash players{*this, mPlayers};
+    for (uint8 level = 0u; level < kDevelopmentCardLevelCount; ++level) {
+      std::array<DevelopmentCard, kMaxHiddenCount> drawn{};
+      mDecks.DrawMany(level, {drawn.data(), hiddenCounts[level]}, aGenerator);
+      for (std::size_t i = 0u; i < hiddenCounts[level]; ++i) {
+        hidden[level][i]->ClearHidden(drawn[i]);
+      }
+    }
+  }
+
+  {
+    Rehash rehash{*this, mDeterminized};
+    mDeterminized = true;
+  }
+  VerifyHash();
 }
 
 // Hide information not visible to provided player
-GameState GameState::MaskHiddenInformation(uint8 aPlayer) {
+GameState GameState::MaskHiddenInformation(uint8 aPlayer) const {
   auto copy = *this;
   auto& otherPlayer = copy.mPlayers[1u - aPlayer];
 
-  for (auto& slot : otherPlayer.GetReservedDevelopmentCards()) {
-    if (slot && !slot.IsRevealed()) {
-      auto card = slot.SetHidden();
-      copy.mDecks.Insert(card);
+  if (HasHiddenInformation(aPlayer)) {
+    Rehash decks{copy, copy.mDecks};
+    Rehash player{copy, otherPlayer};
+    for (auto& slot : otherPlayer.GetReservedDevelopmentCards()) {
+      if (slot && !slot.IsRevealed()) {
+        auto card = slot.SetHidden();
+        copy.mDecks.Insert(card);
+      }
     }
   }
 
-  copy.mDeterminized = false;
+  {
+    Rehash rehash{copy, copy.mDeterminized};
+    copy.mDeterminized = false;
+  }
+  copy.VerifyHash();
   return copy;
 }
 
+uint64 GameState::GetMaskedHash(uint8 aPlayer) const {
+  if (HasHiddenInformation(aPlayer)) {
+    return MaskHiddenInformation(aPlayer).GetHash();
+  }
+
+  // Masking would only clear mDeterminized, so rekey the word holding it.
+  std::size_t offset = offsetof(GameState, mDeterminized);
+  std::size_t word = offset / kWordSize;
+  std::array<char, kWordSize> bytes{};
+  memcpy(bytes.data(), reinterpret_cast<char const*>(this) + word * kWordSize,
+         kWordSize);
+  bytes[offset % kWordSize] = false;
+  uint32 masked{};
+  memcpy(&masked, bytes.data(), kWordSize);
+  return mHash ^ HashWords(word, word + 1u) ^ GetWordKey(word, masked);
+}
+
 bool GameState::HasHiddenInformation(uint8 aPlayer) const {
   auto& otherPlayer = mPlayers[1u - aPlayer];
 
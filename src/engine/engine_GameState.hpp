@@ -2,8 +2,10 @@
 #define ENGINE_GAMESTATE_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstring>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
 #include "engine_DevelopmentCard.hpp"
@@ -15,45 +17,137 @@
 namespace engine {
 
 class Move;
+class MoveList;
 
 class GameState {
  public:
   using Generator = util::Generator;
 
+  /* The game ends with the round in which a player reaches this. */
+  static std::size_t constexpr kWinningPointCount = 15u;
+
   GameState(Generator& aGenerator);
 
   uint8 GetNextPlayer() const { return mNextPlayer; }
   std::vector<Move> GetMoves() const;
+  void GetMoves(MoveList& aMoves) const;
   auto GetNobles() const { return mNobles; }
   auto GetRevealedDevelopmentCards() const { return mRevealed; }
   std::optional<uint8> GetWinner() const;
   auto const& GetPlayers() const { return mPlayers; }
   Gemset const& GetAvailable() const { return mAvailable; }
-  uint8 GetAvailableGold() const { return mGold; }
+  uint8 GetAvailableGold() const {
+    return kGoldCount - mPlayers.front().GetGold() - mPlayers.back().GetGold();
+  }
 
   bool IsTerminal() const;
   void DoMove(Move const& aMove, Generator& aGenerator);
 
+  enum class TurnPhase : uint8 { kAction, kReturn, kNoble };
+  TurnPhase GetPhase() const { return mPhase; }
+
+  /* Zobrist hash of everything operator== compares: the XOR of one 64 bit
+   * key per 32 bit word of the state and its value. Moves only rekey the
+   * words they change. */
+  uint64 GetHash() const { return mHash; }
+  /* The hash recomputed from every word. */
+  uint64 ComputeHash() const;
+
   bool operator==(GameState const& aOther) const {
     ASSERT(mDeterminized == aOther.mDeterminized);
 
-    return 0 == memcmp(this, &aOther, sizeof(*this));
+    return mHash == aOther.mHash &&
+           0 == memcmp(this, &aOther, sizeof(*this));
   }
 
-  GameState MaskHiddenInformation() {
+  GameState MaskHiddenInformation() const {
     return MaskHiddenInformation(mNextPlayer);
   }
-  GameState MaskHiddenInformation(uint8 aPlayer);
+  GameState MaskHiddenInformation(uint8 aPlayer) const;
+  /* MaskHiddenInformation(aPlayer).GetHash(), without the copy when aPlayer
+   * has nothing to hide from. */
+  uint64 GetMaskedHash(uint8 aPlayer) const;
   void Determinize(Generator& aGenerator);
 
   bool HasHiddenInformation(uint8 aPlayer) const;
 
+  /* The revealed cards, then the reserved cards of the player to move: every
+   * card that player could buy, in the order purchase moves list them. The
+   * last slot is always empty so batches fill whole vectors. */
+  static std::size_t constexpr kPurchaseCandidateCount = 16u;
+  template <class T>
+  using PurchaseArray = std::array<T, kPurchaseCandidateCount>;
+
+  /* Fills the candidates and their costs, returns the mask of non-empty
+   * slots. */
+  uint32 GetPurchaseCandidates(PurchaseArray<DevelopmentCard>& aCards,
+                               PurchaseArray<Gemset>& aCosts) const;
+
  private:
   static std::size_t constexpr kDevelopmentCardRevealCount = 4u;
-  static std::size_t constexpr kWinningPointCount = 15u;
   static std::size_t constexpr kMaxTurnCount = 254;
   static std::size_t constexpr kMaxGemCount = 10u;
-  static std::size_t constexpr kMaxCollectCount = 3u;
+  static uint8 constexpr kGoldCount = 5u;
+  /* Checks the incremental hash against ComputeHash after every move. */
+  static bool constexpr kVerifyHash = false;
+
+  static std::size_t constexpr kWordSize = sizeof(uint32);
+  /* Every word but mHash. */
+  static std::size_t constexpr kHashedWordCount = 16u;
+
+  /* The key of a word holding aValue: the SplitMix64 finalizer of the pair,
+   * which stands in for a key table of 2^32 entries per word and gives
+   * distinct pairs distinct keys. */
+  static constexpr uint64 GetWordKey(std::size_t aWord, uint32 aValue) {
+    uint64 key = (uint64{aValue} << 32u) | aWord;
+    key = (key ^ (key >> 30u)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27u)) * 0x94D049BB133111EBull;
+    return key ^ (key >> 31u);
+  }
+
+  /* XOR of the keys of words [aBegin, aEnd). */
+  uint64 HashWords(std::size_t aBegin, std::size_t aEnd) const {
+    uint64 hash{0u};
+    for (std::size_t i = aBegin; i < aEnd; ++i) {
+      uint32 word{};
+      memcpy(&word, reinterpret_cast<char const*>(this) + i * kWordSize,
+             kWordSize);
+      hash ^= GetWordKey(i, word);
+    }
+    return hash;
+  }
+
+  /* Takes the keys of the words holding aFirst through aLast out of the hash
+   * and puts in the keys of their new values once it goes out of scope.
+   * Guards alive at the same time must not share a word. */
+  class Rehash {
+   public:
+    template <class First, class Last>
+    Rehash(GameState& aState, First const& aFirst, Last const& aLast)
+        : mState{aState},
+          mBegin{GetOffset(aState, &aFirst) / kWordSize},
+          mEnd{(GetOffset(aState, &aLast + 1) + kWordSize - 1u) / kWordSize} {
+      mState.mHash ^= mState.HashWords(mBegin, mEnd);
+    }
+    template <class Member>
+    Rehash(GameState& aState, Member const& aMember)
+        : Rehash(aState, aMember, aMember) {}
+    ~Rehash() { mState.mHash ^= mState.HashWords(mBegin, mEnd); }
+
+   private:
+    static std::size_t GetOffset(GameState const& aState, void const* aByte) {
+      return static_cast<char const*>(aByte) -
+             reinterpret_cast<char const*>(&aState);
+    }
+
+    GameState& mState;
+    std::size_t mBegin;
+    std::size_t mEnd;
+  };
+
+  /* Moves to the next phase or player once a move is done. */
+  void EndMove();
+  void VerifyHash() const;
 
   void DoCollectMove(Gemset const& aTake);
   void DoPurchaseMove(DevelopmentCard const& aCard, Generator& aGenerator);
@@ -66,34 +160,38 @@ class GameState {
   DevelopmentCard ReplaceCard(uint8 aLevel, uint8 aIndex,
                               Generator& aGenerator);
 
-  void GetReturnMoves(std::vector<Move>& aMoves) const;
-  void GetNobleMoves(std::vector<Move>& aMoves) const {
-    GetNobleMoves(&aMoves);
-  }
-  std::size_t GetNobleMoves(std::vector<Move>* aMoves) const;
+  void GetReturnMoves(MoveList& aMoves) const;
+  void GetNobleMoves(MoveList& aMoves) const { GetNobleMoves(&aMoves); }
+  std::size_t GetNobleMoves(MoveList* aMoves) const;
   bool HasNobleMoves() const { return GetNobleMoves(nullptr) > 0; }
-  void GetCollectMoves(std::vector<Move>& aMoves) const;
-  void GetCollectMoves(std::vector<Move>& aMoves,
-                       std::size_t aMaxCollectCount) const;
-  void GetPurchaseMoves(std::vector<Move>& aMoves) const;
-  void TryAddPurchaseMove(std::vector<Move>& aMoves,
-                          DevelopmentCard const& aCard) const;
-  void GetReserveMoves(std::vector<Move>& aMoves) const;
+  void GetCollectMoves(MoveList& aMoves) const;
+  void GetPurchaseMoves(MoveList& aMoves) const;
+  void GetReserveMoves(MoveList& aMoves) const;
 
   Player const& GetPlayer() const { return mPlayers[mNextPlayer]; }
   Player& GetPlayer() { return mPlayers[mNextPlayer]; }
 
+  /* Ordered so the members leave no padding: operator== can compare the
+   * state with memcmp. The bank's gold is whatever the players do not
+   * hold. */
   Decks mDecks{};
   std::array<Player, 2u> mPlayers{};
+  Gemset mAvailable{4u};
   using RevealedRow = std::array<DevelopmentCard, kDevelopmentCardRevealCount>;
   std::array<RevealedRow, kDevelopmentCardLevelCount> mRevealed;
   std::array<NobleCard, NobleCard::kRevealedNobleCount> mNobles;
-  Gemset mAvailable{4u};
-  uint8 mGold{5u};
   uint8 mNextPlayer;
+  TurnPhase mPhase{TurnPhase::kAction};
   bool mDeterminized{true};
+  /* Turns completed by both players together. */
+  uint16 mTurnCount{0u};
+  /* Last, so it is the only word the hash leaves out. */
+  uint64 mHash{0u};
 };
 
+static_assert(sizeof(GameState) == 72u);
+static_assert(std::has_unique_object_representations_v<GameState>);
+
 }  // namespace engine
 
 #endif  // ENGINE_GAMESTATE_HPP
\ No newline at end of file
@@ -11,16 +11,24 @@ static std::size_t constexpr kGemColorCount = 5;
 
 enum class Color : uint8 { kWhite, kBlue, kGreen, kRed, kBlack };
 
+/* Gemset arithmetic either loops over the colors or works on every lane of
+ * the packed word at once. The scalar loops stay around as the reference. */
+enum class GemsetKernel : uint8 { kScalar, kSwar };
+static GemsetKernel constexpr kGemsetKernel = GemsetKernel::kSwar;
+
 class Gemset {
  public:
-  Gemset() {}
-  Gemset(std::size_t aFirst) {
+  /* Largest count a color can hold. */
+  static std::size_t constexpr kMaxCount = 63u;
+
+  constexpr Gemset() {}
+  constexpr Gemset(std::size_t aFirst) {
     for (std::size_t i = 0u; i < kGemColorCount; ++i) {
       Set(i, aFirst);
     }
   }
-  Gemset(std::size_t aWhite, std::size_t aBlue, std::size_t aGreen,
-         std::size_t aRed, std::size_t aBlack) {
+  constexpr Gemset(std::size_t aWhite, std::size_t aBlue, std::size_t aGreen,
+                   std::size_t aRed, std::size_t aBlack) {
     Set(Color::kWhite, aWhite);
     Set(Color::kBlue, aBlue);
     Set(Color::kGreen, aGreen);
@@ -28,40 +36,62 @@ class Gemset {
     Set(Color::kBlack, aBlack);
   }
 
-  std::size_t Get(std::size_t aIndex) const { return mStorage[aIndex]; }
-  std::size_t Get(Color aColor) const {
+  constexpr std::size_t Get(std::size_t aIndex) const {
+    return (mStorage >> (aIndex * kLaneBits)) & kLaneMask;
+  }
+  constexpr std::size_t Get(Color aColor) const {
     return Get(static_cast<std::size_t>(aColor));
   }
 
-  void Set(std::size_t aIndex, std::size_t aValue) {
-    mStorage[aIndex] = aValue;
+  constexpr void Set(std::size_t aIndex, std::size_t aValue) {
+    mStorage &= ~(kLaneMask << (aIndex * kLaneBits));
+    mStorage |= (aValue & kLaneMask) << (aIndex * kLaneBits);
   }
-  void Set(Color aColor, std::size_t aValue) {
+  constexpr void Set(Color aColor, std::size_t aValue) {
     Set(static_cast<std::size_t>(aColor), aValue);
   }
 
+  /* Colors may not go past kMaxCount or below zero. */
+  template <GemsetKernel aKernel = kGemsetKernel>
   static Gemset Add(Gemset const& aLeft, Gemset const& aRight) {
-    Gemset diff{};
-    for (std::size_t i = 0u; i < kGemColorCount; ++i) {
-      diff.Set(i, aLeft.Get(i) + aRight.Get(i));
+    Gemset sum{};
+    if constexpr (aKernel == GemsetKernel::kSwar) {
+      sum.mStorage = aLeft.mStorage + aRight.mStorage;
+    } else {
+      for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+        sum.Set(i, aLeft.Get(i) + aRight.Get(i));
+      }
     }
-    return diff;
+    return sum;
   }
 
+  template <GemsetKernel aKernel = kGemsetKernel>
   static Gemset Sub(Gemset const& aLeft, Gemset const& aRight) {
     Gemset diff{};
-    for (std::size_t i = 0u; i < kGemColorCount; ++i) {
-      diff.Set(i, aLeft.Get(i) - aRight.Get(i));
+    if constexpr (aKernel == GemsetKernel::kSwar) {
+      diff.mStorage = aLeft.mStorage - aRight.mStorage;
+    } else {
+      for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+        diff.Set(i, aLeft.Get(i) - aRight.Get(i));
+      }
     }
     return diff;
   }
 
+  /* Subtracts saturating at zero. Both sides must hold fewer than 32 of each
+   * color. */
+  template <GemsetKernel aKernel = kGemsetKernel>
   static Gemset ApplyDiscount(Gemset const& aCost, Gemset const& aDiscount) {
     Gemset cost{};
 
-    for (std::size_t i = 0u; i < kGemColorCount; ++i) {
-      if (aDiscount.Get(i) < aCost.Get(i)) {
-        cost.Set(i, aCost.Get(i) - aDiscount.Get(i));
+    if constexpr (aKernel == GemsetKernel::kSwar) {
+      ASSERT(!((aCost.mStorage | aDiscount.mStorage) & kGuardBits));
+      cost.mStorage = SubSaturate(aCost.mStorage, aDiscount.mStorage);
+    } else {
+      for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+        if (aDiscount.Get(i) < aCost.Get(i)) {
+          cost.Set(i, aCost.Get(i) - aDiscount.Get(i));
+        }
       }
     }
 
@@ -69,19 +99,73 @@ class Gemset {
   }
 
   /* Returns the number of gold subs needed to afford for each color. */
+  template <GemsetKernel aKernel = kGemsetKernel>
   static std::size_t GetGoldDemand(Gemset const& aDiscount, Gemset const& aHeld,
                                    Gemset const& aCost) {
-    return ApplyDiscount(aCost, Add(aDiscount, aHeld)).GetCount();
+    return ApplyDiscount<aKernel>(aCost, Add<aKernel>(aDiscount, aHeld))
+        .template GetCount<aKernel>();
   }
 
-  std::size_t constexpr GetCount() const {
-    std::size_t count = 0u;
+  /* Whether aHave holds at least aNeed of every color. Both sides must hold
+   * fewer than 32 of each color. */
+  template <GemsetKernel aKernel = kGemsetKernel>
+  static bool Covers(Gemset const& aHave, Gemset const& aNeed) {
+    if constexpr (aKernel == GemsetKernel::kSwar) {
+      ASSERT(!((aHave.mStorage | aNeed.mStorage) & kGuardBits));
+      return (((aHave.mStorage | kGuardBits) - aNeed.mStorage) & kGuardBits) ==
+             kGuardBits;
+    } else {
+      for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+        if (aHave.Get(i) < aNeed.Get(i)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
 
-    for (std::size_t i = 0u; i < kGemColorCount; ++i) {
-      count += Get(i);
+  /* GetGoldDemand for a batch of costs. Sets aMissing[i] to the gems aPower
+   * (discount plus held) lacks for aCosts[i], and bit i of the result when at
+   * most aGold of them are missing. Costs and aPower must hold fewer than 32
+   * of each color. */
+  template <std::size_t aCount, GemsetKernel aKernel = kGemsetKernel>
+  static uint32 GetAffordableMask(Gemset const& aPower, std::size_t aGold,
+                                  std::array<Gemset, aCount> const& aCosts,
+                                  std::array<Gemset, aCount>& aMissing) {
+    static_assert(aCount <= 32u);
+
+    uint32 mask{0u};
+    if constexpr (aKernel == GemsetKernel::kSwar) {
+      ASSERT(!(aPower.mStorage & kGuardBits));
+      for (std::size_t i = 0u; i < aCount; ++i) {
+        aMissing[i].mStorage =
+            SubSaturate(aCosts[i].mStorage, aPower.mStorage);
+        bool affordable = SumLanes(aMissing[i].mStorage) <= aGold;
+        mask |= static_cast<uint32>(affordable) << i;
+      }
+    } else {
+      for (std::size_t i = 0u; i < aCount; ++i) {
+        aMissing[i] = ApplyDiscount<aKernel>(aCosts[i], aPower);
+        bool affordable = aMissing[i].template GetCount<aKernel>() <= aGold;
+        mask |= static_cast<uint32>(affordable) << i;
+      }
     }
+    return mask;
+  }
+
+  template <GemsetKernel aKernel = kGemsetKernel>
+  std::size_t constexpr GetCount() const {
+    if constexpr (aKernel == GemsetKernel::kSwar) {
+      return SumLanes(mStorage);
+    } else {
+      std::size_t count = 0u;
+
+      for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+        count += Get(i);
+      }
 
-    return count;
+      return count;
+    }
   }
 
   bool operator==(Gemset const& aOther) const = default;
@@ -101,7 +185,39 @@ class Gemset {
   }
 
  private:
-  std::array<uint8, kGemColorCount> mStorage{};
+  /* One lane per color, white in the low bits. A nibble would do for gems
+   * and costs, but discount plus held reaches 25 in GetGoldDemand. */
+  static std::size_t constexpr kLaneBits = 6u;
+  static uint32 constexpr kLaneMask = (1u << kLaneBits) - 1u;
+
+  /* Top bit of each lane, clear in the operands of the kernels below so they
+   * can borrow from it. */
+  static uint32 constexpr kGuardBit = 1u << (kLaneBits - 1u);
+  static uint32 constexpr kGuardBits = 0x20820820u;
+  /* White, green and black. */
+  static uint32 constexpr kEvenLanes = 0x3F03F03Fu;
+  static uint32 constexpr kFieldMask = (1u << (2u * kLaneBits)) - 1u;
+
+  /* Lanes where aLeft covers aRight keep their guard bit, which then masks
+   * the lanes that would have gone below zero. */
+  static constexpr uint32 SubSaturate(uint32 aLeft, uint32 aRight) {
+    uint32 diff = (aLeft | kGuardBits) - aRight;
+    uint32 keep = (diff & kGuardBits) >> (kLaneBits - 1u);
+    return diff & (keep * (kGuardBit - 1u));
+  }
+
+  /* Pairs up neighbouring lanes into 12 bit fields, then adds the three
+   * fields. Only 32 bit shifts and adds, so loops over it vectorize. */
+  static constexpr uint32 SumLanes(uint32 aStorage) {
+    uint32 pairs =
+        (aStorage & kEvenLanes) + ((aStorage >> kLaneBits) & kEvenLanes);
+    pairs += (pairs >> (2u * kLaneBits)) + (pairs >> (4u * kLaneBits));
+    return pairs & kFieldMask;
+  }
+
+  uint32 mStorage{0u};
+
+  static_assert(kMaxCount == kLaneMask);
 };
 
 }  // namespace engine
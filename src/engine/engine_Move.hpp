@@ -1,6 +1,8 @@
 #ifndef ENGINE_MOVE_HPP
 #define ENGINE_MOVE_HPP
 
+#include <bit>
+
 #include "engine_DevelopmentCard.hpp"
 #include "engine_Gemset.hpp"
 #include "engine_NobleCard.hpp"
@@ -40,11 +42,8 @@ struct Move {
     } mReturn;
   };
 
-  static Move MakeReturnMove(Gemset aGive) {
-    Move move{};
-    move.mType = MoveType::kReturn;
-    move.mReturn.mGive = aGive;
-    return move;
+  static constexpr Move MakeReturnMove(Gemset aGive) {
+    return Move{.mType = MoveType::kReturn, .mReturn = {aGive}};
   }
 
   static Move MakeNobleMove(NobleCard const& aNoble) {
@@ -54,11 +53,8 @@ struct Move {
     return move;
   }
 
-  static Move MakeCollectMove(Gemset const& aTake) {
-    Move move{};
-    move.mType = MoveType::kCollect;
-    move.mCollect.mTake = aTake;
-    return move;
+  static constexpr Move MakeCollectMove(Gemset const& aTake) {
+    return Move{.mType = MoveType::kCollect, .mCollect = {aTake}};
   }
 
   static Move MakePurchaseMove(DevelopmentCard const& aCard) {
@@ -133,6 +129,33 @@ struct Move {
   bool operator>(Move const& aOther) const {
     return !(*this < aOther) && !(*this == aOther);
   }
+
+  /* Equal for moves operator== finds equal and different otherwise: the
+   * payload operator== compares, then the type in the low bits. */
+  uint64 GetKey() const {
+    uint64 payload{0u};
+    switch (mType) {
+      case MoveType::kCollect:
+        payload = std::bit_cast<uint32>(mCollect.mTake);
+        break;
+      case MoveType::kPurchase:
+        payload = mPurchase.mCard.GetIndex();
+        break;
+      case MoveType::kReserveFaceUp:
+        payload = mReserveFaceUp.mCard.GetIndex();
+        break;
+      case MoveType::kReserveFaceDown:
+        payload = mReserveFaceDown.mLevel;
+        break;
+      case MoveType::kNoble:
+        payload = std::bit_cast<uint8>(mNoble.mNoble);
+        break;
+      case MoveType::kReturn:
+        payload = std::bit_cast<uint32>(mReturn.mGive);
+        break;
+    }
+    return (payload << 3u) | static_cast<uint64>(mType);
+  }
 };
 
 }  // namespace engine
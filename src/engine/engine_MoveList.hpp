@@ -0,0 +1,54 @@
+#ifndef ENGINE_MOVELIST_HPP
+#define ENGINE_MOVELIST_HPP
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#include "engine_Move.hpp"
+#include "util_General.hpp"
+
+namespace engine {
+
+/**
+ * A fixed capacity list of moves, large enough for any move set a state can
+ * produce, so move generation never touches the heap.
+ */
+class MoveList {
+ public:
+  /* 10 collect 3 + 5 collect 2 + 15 purchases + 12 face up + 3 face down
+   * reserves. Return moves peak at 35, noble moves at 3. */
+  static std::size_t constexpr kCapacity = 45u;
+
+  void push_back(Move const& aMove) {
+    ASSERT(mSize < kCapacity);
+    mMoves[mSize++] = aMove;
+  }
+  void emplace_back(Move const& aMove) { push_back(aMove); }
+  void append(std::span<Move const> aMoves) {
+    ASSERT(mSize + aMoves.size() <= kCapacity);
+    std::copy(aMoves.begin(), aMoves.end(), mMoves.begin() + mSize);
+    mSize += aMoves.size();
+  }
+  void clear() { mSize = 0u; }
+
+  std::size_t size() const { return mSize; }
+  bool empty() const { return mSize == 0u; }
+
+  Move const& operator[](std::size_t aIndex) const { return mMoves[aIndex]; }
+  Move const& front() const { return mMoves[0u]; }
+  Move const& back() const { return mMoves[mSize - 1u]; }
+
+  Move const* begin() const { return mMoves.data(); }
+  Move const* end() const { return mMoves.data() + mSize; }
+  Move* begin() { return mMoves.data(); }
+  Move* end() { return mMoves.data() + mSize; }
+
+ private:
+  std::array<Move, kCapacity> mMoves{};
+  uint8 mSize{0u};
+};
+
+}  // namespace engine
+
+#endif  // ENGINE_MOVELIST_HPP
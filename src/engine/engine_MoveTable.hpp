@@ -0,0 +1,184 @@
+#ifndef ENGINE_MOVETABLE_HPP
+#define ENGINE_MOVETABLE_HPP
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#include "engine_Gemset.hpp"
+#include "engine_Move.hpp"
+#include "engine_MoveList.hpp"
+#include "util_General.hpp"
+
+namespace engine {
+
+/**
+ * Collect and return moves built at compile time for every input that decides
+ * them, in the order the nested color loops used to produce them.
+ *
+ * Collect moves only depend on which colors have gems left and which have at
+ * least four, so they are handed back as ready made spans keyed by a color
+ * mask. Return moves depend on the held gems clamped to the return count: each
+ * return count keeps its candidate moves and, per color and clamped held
+ * count, the bitmask of candidates that fit. Intersecting five masks gives the
+ * moves without touching the candidates that do not.
+ */
+class MoveTable {
+ public:
+  static std::size_t constexpr kMaxCollectCount = 3u;
+  static std::size_t constexpr kMaxReturnCount = 3u;
+  static std::size_t constexpr kColorMaskCount = 1u << kGemColorCount;
+
+  /* Bit i set when color i passes aPredicate. */
+  template <class Predicate>
+  static uint8 GetColorMask(Gemset const& aGems, Predicate&& aPredicate) {
+    uint8 mask{0u};
+    for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+      if (aPredicate(aGems.Get(i))) {
+        mask |= 1u << i;
+      }
+    }
+    return mask;
+  }
+
+  /* Takes of one gem from each of min(3, colors) colors in aColorMask. With
+   * nothing left this is the single empty take. */
+  static std::span<Move const> GetCollectMoves(uint8 aColorMask) {
+    return {kCollectTable.mMoves[aColorMask].data(),
+            kCollectTable.mSizes[aColorMask]};
+  }
+
+  /* Takes of two gems of one color in aColorMask. */
+  static std::span<Move const> GetCollectTwoMoves(uint8 aColorMask) {
+    return {kCollectTwoTable.mMoves[aColorMask].data(),
+            kCollectTwoTable.mSizes[aColorMask]};
+  }
+
+  static void GetReturnMoves(Gemset const& aHeld, std::size_t aReturnCount,
+                             MoveList& aMoves) {
+    ASSERT(aReturnCount > 0u && aReturnCount <= kMaxReturnCount);
+
+    auto const& table = kReturnTables[aReturnCount - 1u];
+    uint64 fit = table.mAll;
+    for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+      fit &= table.mFit[i][std::min(aHeld.Get(i), aReturnCount)];
+    }
+
+    util::IterateBitfield(fit, [&](std::size_t aIndex) {
+      aMoves.push_back(table.mMoves[aIndex]);
+    });
+  }
+
+ private:
+  /* C(5, 2) takes of three distinct colors. */
+  static std::size_t constexpr kMaxCollectMoveCount = 10u;
+  /* C(3 + 4, 4) ways to return three gems. */
+  static std::size_t constexpr kMaxReturnMoveCount = 35u;
+
+  template <std::size_t aCapacity>
+  struct CollectTable {
+    std::array<std::array<Move, aCapacity>, kColorMaskCount> mMoves{};
+    std::array<uint8, kColorMaskCount> mSizes{};
+  };
+
+  struct ReturnTable {
+    std::array<Move, kMaxReturnMoveCount> mMoves{};
+    uint64 mAll{0u};
+    std::array<std::array<uint64, kMaxReturnCount + 1u>, kGemColorCount>
+        mFit{};
+  };
+
+  /* Calls aVisit with every gemset of aCount gems at most aLimit per color,
+   * white varying slowest. */
+  template <class Visit>
+  static constexpr void ForEachGemset(Gemset const& aLimit, std::size_t aCount,
+                                      Visit&& aVisit) {
+    std::size_t W = aLimit.Get(Color::kWhite);
+    std::size_t U = aLimit.Get(Color::kBlue);
+    std::size_t G = aLimit.Get(Color::kGreen);
+    std::size_t R = aLimit.Get(Color::kRed);
+    std::size_t B = aLimit.Get(Color::kBlack);
+
+    for (std::size_t w = 0u; w <= std::min(W, aCount); ++w) {
+      for (std::size_t u = 0u; u <= std::min(U, aCount - w); ++u) {
+        for (std::size_t g = 0u; g <= std::min(G, aCount - w - u); ++g) {
+          for (std::size_t r = 0u; r <= std::min(R, aCount - w - u - g); ++r) {
+            std::size_t b = aCount - w - u - g - r;
+            if (b <= B) {
+              aVisit(Gemset(w, u, g, r, b));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  static constexpr Gemset GetLimit(uint8 aColorMask, std::size_t aLimit) {
+    Gemset limit{};
+    for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+      if (aColorMask & (1u << i)) {
+        limit.Set(i, aLimit);
+      }
+    }
+    return limit;
+  }
+
+  static constexpr CollectTable<kMaxCollectMoveCount> MakeCollectTable() {
+    CollectTable<kMaxCollectMoveCount> table{};
+    for (std::size_t mask = 0u; mask < kColorMaskCount; ++mask) {
+      auto limit = GetLimit(mask, 1u);
+      std::size_t count = std::min(limit.GetCount(), kMaxCollectCount);
+      ForEachGemset(limit, count, [&](Gemset const& aTake) {
+        table.mMoves[mask][table.mSizes[mask]++] =
+            Move::MakeCollectMove(aTake);
+      });
+    }
+    return table;
+  }
+
+  static constexpr CollectTable<kGemColorCount> MakeCollectTwoTable() {
+    CollectTable<kGemColorCount> table{};
+    for (std::size_t mask = 0u; mask < kColorMaskCount; ++mask) {
+      for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+        if (mask & (1u << i)) {
+          Gemset take{};
+          take.Set(i, 2u);
+          table.mMoves[mask][table.mSizes[mask]++] =
+              Move::MakeCollectMove(take);
+        }
+      }
+    }
+    return table;
+  }
+
+  static constexpr ReturnTable MakeReturnTable(std::size_t aReturnCount) {
+    ReturnTable table{};
+    std::size_t size{0u};
+    ForEachGemset(Gemset(aReturnCount), aReturnCount, [&](Gemset const& aGive) {
+      for (std::size_t i = 0u; i < kGemColorCount; ++i) {
+        for (std::size_t held = aGive.Get(i); held <= aReturnCount; ++held) {
+          table.mFit[i][held] |= 1ull << size;
+        }
+      }
+      table.mAll |= 1ull << size;
+      table.mMoves[size++] = Move::MakeReturnMove(aGive);
+    });
+    return table;
+  }
+
+  static CollectTable<kMaxCollectMoveCount> const kCollectTable;
+  static CollectTable<kGemColorCount> const kCollectTwoTable;
+  static std::array<ReturnTable, kMaxReturnCount> const kReturnTables;
+};
+
+inline constexpr MoveTable::CollectTable<MoveTable::kMaxCollectMoveCount>
+    MoveTable::kCollectTable = MakeCollectTable();
+inline constexpr MoveTable::CollectTable<kGemColorCount>
+    MoveTable::kCollectTwoTable = MakeCollectTwoTable();
+inline constexpr std::array<MoveTable::ReturnTable, MoveTable::kMaxReturnCount>
+    MoveTable::kReturnTables{MakeReturnTable(1u), MakeReturnTable(2u),
+                             MakeReturnTable(3u)};
+
+}  // namespace engine
+
+#endif  // ENGINE_MOVETABLE_HPP
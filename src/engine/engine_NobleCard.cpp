@@ -4,22 +4,9 @@
 
 namespace engine {
 
-std::array<NobleCard::Internal, 10> const NobleCard::kAllNobleCards = {
-    NobleCard::Internal(Gemset(4, 4, 0, 0, 0)),
-    NobleCard::Internal(Gemset(0, 4, 4, 0, 0)),
-    NobleCard::Internal(Gemset(0, 0, 4, 4, 0)),
-    NobleCard::Internal(Gemset(0, 0, 0, 4, 4)),
-    NobleCard::Internal(Gemset(4, 0, 0, 0, 4)),
-    NobleCard::Internal(Gemset(3, 3, 3, 0, 0)),
-    NobleCard::Internal(Gemset(0, 3, 3, 3, 0)),
-    NobleCard::Internal(Gemset(0, 0, 3, 3, 3)),
-    NobleCard::Internal(Gemset(3, 0, 0, 3, 3)),
-    NobleCard::Internal(Gemset(3, 3, 0, 0, 3)),
-};
-
 std::array<NobleCard, NobleCard::kRevealedNobleCount> NobleCard::ShuffleNobles(
     util::Generator& aGenerator) {
-  std::array<uint8, kAllNobleCards.size()> allNobles{};
+  std::array<uint8, CardTable::kNobleCardCount> allNobles{};
 
   for (std::size_t i = 0u; i < allNobles.size(); ++i) {
     allNobles[i] = i;
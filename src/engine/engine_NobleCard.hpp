@@ -4,6 +4,7 @@
 #include <array>
 #include <limits>
 
+#include "engine_CardTable.hpp"
 #include "engine_Gemset.hpp"
 #include "util_General.hpp"
 
@@ -14,8 +15,10 @@ class NobleCard {
   NobleCard() = default;
   NobleCard(uint8 aIndex) : mIndex(aIndex) {}
 
-  uint8 GetPoints() const { return ResolveCard(mIndex)->GetPoints(); }
-  Gemset const& GetCost() const { return ResolveCard(mIndex)->GetCost(); }
+  uint8 GetPoints() const { return CardTable::GetNobleCard(mIndex).mPoints; }
+  Gemset const& GetCost() const {
+    return CardTable::GetNobleCard(mIndex).mCost;
+  }
 
   operator bool() const { return IsValid(); }
   bool IsValid() const { return mIndex != kInvalidNobleCard; }
@@ -32,27 +35,7 @@ class NobleCard {
   }
 
  private:
-  class Internal {
-   public:
-    Internal(Gemset const& aCost) : mCost(aCost) {}
-
-    uint8 GetPoints() const { return 3u; }
-    Gemset const& GetCost() const { return mCost; }
-
-   private:
-    Gemset mCost{};
-  };
-
-  static Internal const* ResolveCard(uint8 aIndex) {
-    if (aIndex < kAllNobleCards.size()) {
-      return &kAllNobleCards[aIndex];
-    }
-
-    return nullptr;
-  }
-
   static uint8 constexpr kInvalidNobleCard = std::numeric_limits<uint8>::max();
-  static std::array<Internal, 10u> const kAllNobleCards;
 
   uint8 mIndex{kInvalidNobleCard};
 };
@@ -11,12 +11,11 @@ namespace engine {
 
 class Player {
  public:
-  std::size_t constexpr GetGemCount() const { return mHeld.GetCount() + mGold; }
-
-  std::size_t GetPoints() const { return mPoints; }
+  std::size_t constexpr GetGemCount() const {
+    return mHeld.GetCount() + GetGold();
+  }
 
-  void AddTurn() { mTurnCount++; }
-  std::size_t GetTurnCount() const { return mTurnCount; }
+  std::size_t GetPoints() const { return mGoldAndPoints >> kGoldBits; }
 
   uint8 GetDevelopmentCardCount() const { return mDiscount.GetCount(); }
 
@@ -29,36 +28,40 @@ class Player {
   auto const& GetReservedDevelopmentCards() const { return mReserved; }
   auto& GetReservedDevelopmentCards() { return mReserved; }
 
-  uint8 GetGold() const { return mGold; }
-  void AddGold(uint8 aCount) { mGold += aCount; }
+  constexpr uint8 GetGold() const { return mGoldAndPoints & kGoldMask; }
+  void AddGold(uint8 aCount) {
+    ASSERT(GetGold() + aCount <= kGoldMask);
+    mGoldAndPoints += aCount;
+  }
   void RemoveGold(uint8 aCount) {
-    ASSERT(mGold >= aCount);
-    mGold -= aCount;
+    ASSERT(GetGold() >= aCount);
+    mGoldAndPoints -= aCount;
   }
   Gemset const& GetHeld() const { return mHeld; }
   Gemset const& GetDiscount() const { return mDiscount; }
 
-  void AddPoints(std::size_t aPoints) { mPoints += aPoints; }
+  void AddPoints(std::size_t aPoints) {
+    ASSERT(GetPoints() + aPoints <= kMaxPointCount);
+    mGoldAndPoints += aPoints << kGoldBits;
+  }
   void AddDiscount(Color aColor) {
     mDiscount.Set(aColor, mDiscount.Get(aColor) + 1u);
   }
 
-  enum class TurnPhase : uint8 { kAction, kReturn, kNoble };
-  TurnPhase GetPhase() const { return mPhase; }
-  void SetPhase(TurnPhase aPhase) { mPhase = aPhase; }
-
   bool operator==(Player const& aOther) const = default;
 
  private:
   static std::size_t constexpr kReservedCardMaxCount{3u};
+  /* Gold fits in 3 bits, points in the other 5: the game ends with the round
+   * in which someone reaches 15, so nobody gets past 22. */
+  static uint8 constexpr kGoldBits{3u};
+  static uint8 constexpr kGoldMask{(1u << kGoldBits) - 1u};
+  static std::size_t constexpr kMaxPointCount{0xFFu >> kGoldBits};
 
-  uint8 mTurnCount{0u};
   Gemset mHeld{};
   Gemset mDiscount{};
   std::array<DevelopmentCard, kReservedCardMaxCount> mReserved{};
-  uint8 mGold{0u};
-  uint8 mPoints{0u};
-  TurnPhase mPhase{TurnPhase::kAction};
+  uint8 mGoldAndPoints{0u};
 };
 
 }  // namespace engine
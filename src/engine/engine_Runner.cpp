@@ -13,14 +13,19 @@ std::optional<uint8> Runner::RunGame(Generator& aGenerator) const {
 }
 
 std::optional<uint8> Runner::RunGame(GameState& aState,
-                                     Generator& aGenerator) const {
+                                     Generator& aGenerator,
+                                     std::size_t aMaxPlyCount) const {
   ASSERT(mAgents.size() == 2u);
 
   for (size_t i = 0u; i < mAgents.size(); ++i) {
     mAgents[i]->OnSetup(aState, i);
   }
 
-  while (!aState.IsTerminal()) {
+  for (std::size_t ply = 0u; !aState.IsTerminal(); ++ply) {
+    if (ply == aMaxPlyCount) {
+      return std::nullopt;
+    }
+
     for (auto const& view : mViews) {
       view->ShowState(aState);
     }
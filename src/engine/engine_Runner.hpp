@@ -1,6 +1,7 @@
 #ifndef ENGINE_RUNNER_HPP
 #define ENGINE_RUNNER_HPP
 
+#include <limits>
 #include <optional>
 #include <vector>
 
@@ -16,6 +17,9 @@ class Runner {
  public:
   using Generator = util::Generator;
 
+  static std::size_t constexpr kNoPlyLimit =
+      std::numeric_limits<std::size_t>::max();
+
   void AddAgent(IAgent* aAgent) { mAgents.push_back(aAgent); }
   void AddView(IView* aView) { mViews.push_back(aView); }
 
@@ -25,7 +29,10 @@ class Runner {
   }
 
   std::optional<uint8> RunGame(Generator& aGenerator) const;
-  std::optional<uint8> RunGame(GameState& aState, Generator& aGenerator) const;
+  /* Plays aState to the end, or leaves it after aMaxPlyCount plies with no
+   * winner. */
+  std::optional<uint8> RunGame(GameState& aState, Generator& aGenerator,
+                               std::size_t aMaxPlyCount = kNoPlyLimit) const;
 
  private:
   std::vector<IAgent*> mAgents{};
@@ -4,6 +4,8 @@
 #include "agent_Random.hpp"
 #include "agent_SmartRollout.hpp"
 #include "engine_Runner.hpp"
+#include "test_Benchmark.hpp"
+#include "test_Check.hpp"
 #include "test_Collect.hpp"
 #include "test_Episode.hpp"
 #include "test_IAgentFactory.hpp"
@@ -37,6 +39,8 @@ class OptionsFactory : public test::IAgentFactory {
 };
 
 #define TEST 0
+#define BENCHMARK 0
+#define CHECK 0
 #if TEST
 int main() {
   MctsFactory mcts1{};
@@ -83,6 +87,13 @@ int main() {
   }
   return 0;
 }
+#elif BENCHMARK
+int main() {
+  test::RunBenchmarks(std::cout);
+  return 0;
+}
+#elif CHECK
+int main() { return test::RunChecks(std::cout) ? 0 : 1; }
 #else
 int main() {
   auto generator = util::MakeGenerator();
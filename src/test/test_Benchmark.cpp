@@ -0,0 +1,731 @@
+#include "test_Benchmark.hpp"
+
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "agent_MonteCarloTreeSearch.hpp"
+#include "agent_PrunedRandom.hpp"
+#include "agent_Random.hpp"
+#include "agent_Rollout.hpp"
+#include "agent_SmartRollout.hpp"
+#include "agent_UcbBatch.hpp"
+#include "engine_CardTable.hpp"
+#include "engine_DevelopmentCard.hpp"
+#include "engine_GameState.hpp"
+#include "engine_Gemset.hpp"
+#include "engine_IAgent.hpp"
+#include "engine_Move.hpp"
+#include "engine_MoveList.hpp"
+#include "engine_Runner.hpp"
+#include "util_Allocation.hpp"
+#include "util_TimeStamp.hpp"
+
+namespace test {
+
+static std::size_t constexpr kPositionCount{8u};
+static std::size_t constexpr kPositionSeed{1u};
+
+/* Reproducible positions spread over the opening and middle game. */
+static std::vector<engine::GameState> MakePositions(std::size_t aCount) {
+  util::Generator generator{kPositionSeed};
+  agent::SmartRollout policy{generator};
+
+  std::vector<engine::GameState> positions{};
+  while (positions.size() < aCount) {
+    engine::GameState state{generator};
+    std::size_t plies = positions.size() * 4u;
+
+    for (std::size_t i = 0u; i < plies && !state.IsTerminal(); ++i) {
+      state.DoMove(policy.OnTurn(state.MaskHiddenInformation()), generator);
+    }
+
+    if (!state.IsTerminal()) {
+      positions.push_back(state);
+    }
+  }
+
+  return positions;
+}
+
+/* Every state seen while playing aGameCount rollout games. */
+static std::vector<engine::GameState> MakeGameStates(std::size_t aGameCount) {
+  util::Generator generator{kPositionSeed};
+  agent::SmartRollout policy{generator};
+
+  std::vector<engine::GameState> states{};
+  for (std::size_t i = 0u; i < aGameCount; ++i) {
+    engine::GameState state{generator};
+    while (!state.IsTerminal()) {
+      states.push_back(state);
+      state.DoMove(policy.OnTurn(state.MaskHiddenInformation()), generator);
+    }
+  }
+
+  return states;
+}
+
+static void ShowRate(std::ostream& aOut, std::string const& aName,
+                     double aCount, double aSeconds,
+                     std::string const& aUnit) {
+  aOut << std::left << std::setw(24) << aName << std::right << std::fixed
+       << std::setprecision(0) << std::setw(14) << (aCount / aSeconds) << " "
+       << aUnit << "/s\n";
+}
+
+void RunBenchmarks(std::ostream& aOut) {
+  BenchmarkGemsetKernels(aOut);
+  BenchmarkDeckDraws(aOut);
+  BenchmarkGenerators(aOut);
+  BenchmarkUcbKernels(aOut);
+  BenchmarkStateCopies(aOut);
+  BenchmarkMoveGeneration(aOut);
+  BenchmarkRollouts(aOut, 5u);
+  BenchmarkSearchParallelism(aOut, 4u, 1.0f);
+  BenchmarkTranspositions(aOut, 1.0f);
+  BenchmarkTreeMemory(aOut, 1.0f);
+  BenchmarkTreeIterations(aOut, 1.0f);
+  BenchmarkRolloutCutoff(aOut, 30u, 20u, 0.05f);
+}
+
+void BenchmarkSearchParallelism(std::ostream& aOut, std::size_t aThreadCount,
+                                float aSeconds) {
+  using Options = agent::MonteCarloTreeSearch::Options;
+
+  struct Config {
+    std::string mName;
+    std::size_t mThreadCount;
+    Options::Parallelism mParallelism;
+  };
+
+  std::vector<Config> configs{
+      {"single", 1u, Options::Parallelism::kRoot},
+      {"root x" + std::to_string(aThreadCount), aThreadCount,
+       Options::Parallelism::kRoot},
+      {"tree x" + std::to_string(aThreadCount), aThreadCount,
+       Options::Parallelism::kTree},
+  };
+
+  auto positions = MakePositions(kPositionCount);
+
+  aOut << "--- SEARCH PARALLELISM ---\n";
+  for (auto const& config : configs) {
+    Options options{};
+    options.mTimeoutSeconds = aSeconds;
+    options.mThreadCount = config.mThreadCount;
+    options.mParallelism = config.mParallelism;
+
+    std::size_t rolloutCount{0u};
+    std::size_t maxPath{0u};
+    double seconds{0.0};
+
+    for (auto position : positions) {
+      util::Generator generator{kPositionSeed};
+      agent::MonteCarloTreeSearch search{generator, options};
+      search.OnSetup(position, position.GetNextPlayer());
+      search.OnTurn(position.MaskHiddenInformation());
+
+      auto const& statistics = search.GetStatistics();
+      rolloutCount += statistics.mRolloutCount;
+      maxPath += statistics.mMaxPath;
+      seconds += statistics.mSeconds;
+    }
+
+    ShowRate(aOut, config.mName, rolloutCount, seconds, "rollouts");
+    aOut << std::left << std::setw(24) << "" << std::right << std::fixed
+         << std::setprecision(1) << std::setw(14)
+         << (static_cast<double>(maxPath) / positions.size())
+         << " mean depth\n";
+  }
+  aOut << "\n";
+}
+
+void BenchmarkTranspositions(std::ostream& aOut, float aSeconds) {
+  using Options = agent::MonteCarloTreeSearch::Options;
+
+  auto positions = MakePositions(kPositionCount);
+
+  aOut << "--- TRANSPOSITIONS ---\n";
+  for (bool transpositions : {false, true}) {
+    Options options{};
+    options.mTimeoutSeconds = aSeconds;
+    options.mTranspositions = transpositions;
+
+    std::size_t rolloutCount{0u};
+    std::size_t stateCount{0u};
+    std::size_t transpositionCount{0u};
+    double seconds{0.0};
+
+    for (auto position : positions) {
+      util::Generator generator{kPositionSeed};
+      agent::MonteCarloTreeSearch search{generator, options};
+      search.OnSetup(position, position.GetNextPlayer());
+      search.OnTurn(position.MaskHiddenInformation());
+
+      auto const& statistics = search.GetStatistics();
+      rolloutCount += statistics.mRolloutCount;
+      stateCount += statistics.mStateCount;
+      transpositionCount += statistics.mTranspositionCount;
+      seconds += statistics.mSeconds;
+    }
+
+    std::string name = transpositions ? "table" : "tree";
+    ShowRate(aOut, name, rolloutCount, seconds, "rollouts");
+    aOut << std::left << std::setw(24) << "" << std::right << std::setw(14)
+         << (stateCount / positions.size()) << " states\n";
+    aOut << std::left << std::setw(24) << "" << std::right << std::fixed
+         << std::setprecision(1) << std::setw(14)
+         << (static_cast<double>(rolloutCount) / stateCount)
+         << " rollouts per state\n";
+    aOut << std::left << std::setw(24) << "" << std::right << std::setw(14)
+         << (transpositionCount / positions.size()) << " transpositions\n";
+  }
+  aOut << "\n";
+}
+
+void BenchmarkTreeMemory(std::ostream& aOut, float aSeconds) {
+  agent::MonteCarloTreeSearch::Options options{};
+  options.mTimeoutSeconds = aSeconds;
+
+  auto positions = MakePositions(kPositionCount);
+
+  std::size_t rolloutCount{0u};
+  std::size_t nodeCount{0u};
+  std::size_t nodeBytes{0u};
+  double seconds{0.0};
+
+  for (auto position : positions) {
+    util::Generator generator{kPositionSeed};
+    agent::MonteCarloTreeSearch search{generator, options};
+    search.OnSetup(position, position.GetNextPlayer());
+    search.OnTurn(position.MaskHiddenInformation());
+
+    auto const& statistics = search.GetStatistics();
+    rolloutCount += statistics.mRolloutCount;
+    nodeCount += statistics.mNodeCount;
+    nodeBytes += statistics.mNodeBytes;
+    seconds += statistics.mSeconds;
+  }
+
+  aOut << "--- TREE MEMORY ---\n";
+  ShowRate(aOut, "search", rolloutCount, seconds, "rollouts");
+  aOut << std::left << std::setw(24) << "" << std::right << std::setw(14)
+       << (nodeCount / positions.size()) << " nodes\n";
+  aOut << std::left << std::setw(24) << "" << std::right << std::fixed
+       << std::setprecision(1) << std::setw(14)
+       << (static_cast<double>(nodeBytes) / nodeCount) << " bytes per node\n";
+  aOut << "\n";
+}
+
+void BenchmarkTreeIterations(std::ostream& aOut, float aSeconds) {
+  using Options = agent::MonteCarloTreeSearch::Options;
+
+  struct Config {
+    std::string mName;
+    bool mProgressiveWidening;
+    Options::Determinization mDeterminization;
+  };
+
+  std::vector<Config> configs{
+      {"full width", false, Options::Determinization::kPerNode},
+      {"widening", true, Options::Determinization::kPerNode},
+      {"full width per iter", false, Options::Determinization::kPerIteration},
+      {"widening per iter", true, Options::Determinization::kPerIteration},
+  };
+
+  Options options{};
+  options.mTimeoutSeconds = aSeconds;
+  options.mMaxRolloutPlies = 0u;
+  options.mSimsPerRollout = 1u;
+
+  auto positions = MakePositions(kPositionCount);
+
+  aOut << "--- TREE ITERATIONS ---\n";
+  for (auto const& config : configs) {
+    options.mProgressiveWidening = config.mProgressiveWidening;
+    options.mDeterminization = config.mDeterminization;
+
+    std::size_t iterationCount{0u};
+    std::size_t maxPath{0u};
+    double seconds{0.0};
+
+    for (auto position : positions) {
+      util::Generator generator{kPositionSeed};
+      agent::MonteCarloTreeSearch search{generator, options};
+      search.OnSetup(position, position.GetNextPlayer());
+      search.OnTurn(position.MaskHiddenInformation());
+
+      auto const& statistics = search.GetStatistics();
+      iterationCount += statistics.mRolloutCount;
+      maxPath += statistics.mMaxPath;
+      seconds += statistics.mSeconds;
+    }
+
+    ShowRate(aOut, config.mName, iterationCount, seconds, "iterations");
+    aOut << std::left << std::setw(24) << "" << std::right << std::fixed
+         << std::setprecision(1) << std::setw(14)
+         << (static_cast<double>(maxPath) / positions.size())
+         << " mean depth\n";
+  }
+  aOut << "\n";
+}
+
+void BenchmarkRolloutCutoff(std::ostream& aOut, std::size_t aMaxPlyCount,
+                            std::size_t aGameCount, float aSeconds) {
+  using Options = agent::MonteCarloTreeSearch::Options;
+
+  Options full{};
+  full.mTimeoutSeconds = aSeconds;
+  Options cutoff = full;
+  cutoff.mMaxRolloutPlies = aMaxPlyCount;
+  std::string cutoffName = "cut at " + std::to_string(aMaxPlyCount);
+
+  auto positions = MakePositions(kPositionCount);
+
+  aOut << "--- ROLLOUT CUTOFF ---\n";
+  for (bool cut : {false, true}) {
+    std::size_t rolloutCount{0u};
+    double seconds{0.0};
+
+    for (auto position : positions) {
+      util::Generator generator{kPositionSeed};
+      agent::MonteCarloTreeSearch search{generator, cut ? cutoff : full};
+      search.OnSetup(position, position.GetNextPlayer());
+      search.OnTurn(position.MaskHiddenInformation());
+
+      auto const& statistics = search.GetStatistics();
+      rolloutCount += statistics.mRolloutCount;
+      seconds += statistics.mSeconds;
+    }
+
+    ShowRate(aOut, cut ? cutoffName : "full", rolloutCount, seconds,
+             "rollouts");
+  }
+
+  // The cut search against the full one, taking turns to move first.
+  std::size_t winCount{0u};
+  std::size_t lossCount{0u};
+  for (std::size_t game = 0u; game < aGameCount; ++game) {
+    util::Generator generator{kPositionSeed + game};
+    agent::MonteCarloTreeSearch cutSearch{generator, cutoff};
+    agent::MonteCarloTreeSearch fullSearch{generator, full};
+    uint8 cutPlayer = game % 2u;
+
+    engine::Runner runner{};
+    runner.AddAgent(cutPlayer == 0u ? &cutSearch : &fullSearch);
+    runner.AddAgent(cutPlayer == 0u ? &fullSearch : &cutSearch);
+    auto winner = runner.RunGame(generator);
+    if (winner) {
+      (*winner == cutPlayer ? winCount : lossCount)++;
+    }
+  }
+
+  aOut << std::left << std::setw(24) << cutoffName << std::right
+       << std::setw(14) << winCount << " wins\n";
+  aOut << std::left << std::setw(24) << "" << std::right << std::setw(14)
+       << lossCount << " losses\n";
+  aOut << std::left << std::setw(24) << "" << std::right << std::setw(14)
+       << (aGameCount - winCount - lossCount) << " draws\n";
+  aOut << "\n";
+}
+
+/* Forwards to aPolicy and counts the plies the Runner asks for. */
+template <class Policy>
+class PlyCounter : public engine::IAgent {
+ public:
+  PlyCounter(Policy& aPolicy) : mPolicy(aPolicy) {}
+
+  void OnSetup(engine::GameState const& aState, uint8 aPlayerId) override {}
+  engine::Move OnTurn(engine::GameState const& aState) override {
+    mPlyCount++;
+    return mPolicy.OnTurn(aState);
+  }
+
+  std::size_t mPlyCount{0u};
+
+ private:
+  Policy& mPolicy;
+};
+
+template <class Policy>
+static void BenchmarkRollout(std::ostream& aOut, std::string const& aName,
+                             std::size_t aBatchSize) {
+  static std::size_t constexpr kRepeatCount{100u};
+
+  auto positions = MakePositions(kPositionCount);
+
+  util::Generator generator{kPositionSeed};
+  Policy policy{generator};
+  PlyCounter<Policy> counter{policy};
+  engine::Runner runner{};
+  runner.AddAgent(&counter);
+  runner.AddAgent(&counter);
+
+  std::vector<engine::GameState> states{};
+  std::vector<std::optional<uint8>> winners(aBatchSize);
+  auto measure = [&](std::string const& aPath, auto&& aRun) {
+    std::size_t plyCount{0u};
+    util::TimeStamp start{};
+    for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+      for (auto const& position : positions) {
+        states.assign(aBatchSize, position);
+        plyCount += aRun();
+      }
+    }
+    ShowRate(aOut, aName + " " + aPath, plyCount, start.Since(), "plies");
+  };
+
+  measure("Runner", [&] {
+    counter.mPlyCount = 0u;
+    for (std::size_t i = 0u; i < states.size(); ++i) {
+      winners[i] = runner.RunGame(states[i], generator);
+    }
+    return counter.mPlyCount;
+  });
+  measure("RunRollouts", [&] {
+    return agent::RunRollouts(policy, std::span(states),
+                              std::span(winners), generator);
+  });
+}
+
+void BenchmarkRollouts(std::ostream& aOut, std::size_t aBatchSize) {
+  aOut << "--- ROLLOUTS ---\n";
+  BenchmarkRollout<agent::SmartRollout>(aOut, "SmartRollout", aBatchSize);
+  BenchmarkRollout<agent::PrunedRandom>(aOut, "PrunedRandom", aBatchSize);
+  BenchmarkRollout<agent::Random>(aOut, "Random", aBatchSize);
+  aOut << "\n";
+}
+
+void BenchmarkMoveGeneration(std::ostream& aOut) {
+  static std::size_t constexpr kRepeatCount{20u};
+
+  auto states = MakeGameStates(64u);
+
+  aOut << "--- MOVE GENERATION ---\n";
+  {
+    std::size_t moveCount{0u};
+    util::TimeStamp start{};
+    for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+      for (auto const& state : states) {
+        moveCount += state.GetMoves().size();
+      }
+    }
+    ShowRate(aOut, "std::vector", moveCount, start.Since(), "moves");
+  }
+  {
+    std::size_t moveCount{0u};
+    engine::MoveList moves{};
+    util::TimeStamp start{};
+    for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+      for (auto const& state : states) {
+        state.GetMoves(moves);
+        moveCount += moves.size();
+      }
+    }
+    ShowRate(aOut, "MoveList", moveCount, start.Since(), "moves");
+  }
+#if COUNT_ALLOCATIONS
+  {
+    static std::size_t constexpr kGameCount{256u};
+
+    util::Generator generator{kPositionSeed};
+    agent::SmartRollout policy{generator};
+    engine::Runner runner{};
+    runner.AddAgent(&policy);
+    runner.AddAgent(&policy);
+
+    std::size_t allocationCount = util::GetAllocationCount();
+    for (std::size_t i = 0u; i < kGameCount; ++i) {
+      engine::GameState state{generator};
+      runner.RunGame(state, generator);
+    }
+    allocationCount = util::GetAllocationCount() - allocationCount;
+
+    aOut << std::left << std::setw(24) << "SmartRollout game" << std::right
+         << std::fixed << std::setprecision(1) << std::setw(14)
+         << (static_cast<double>(allocationCount) / kGameCount)
+         << " allocations/game\n";
+  }
+#endif
+  aOut << "\n";
+}
+
+void BenchmarkStateCopies(std::ostream& aOut) {
+  static std::size_t constexpr kRepeatCount{200u};
+
+  auto const states = MakeGameStates(64u);
+
+  aOut << "--- STATE COPIES ---\n";
+  aOut << std::left << std::setw(24) << "sizeof(GameState)" << std::right
+       << std::setw(14) << sizeof(engine::GameState) << " bytes\n";
+  {
+    auto copies = states;
+    util::TimeStamp start{};
+    for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+      for (std::size_t j = 0u; j < states.size(); ++j) {
+        copies[j] = states[(i + j) % states.size()];
+      }
+    }
+    ShowRate(aOut, "copy", kRepeatCount * states.size(), start.Since(),
+             "copies");
+
+    copies = states;
+    std::size_t equalCount{0u};
+    start = util::TimeStamp{};
+    for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+      for (std::size_t j = 0u; j < states.size(); ++j) {
+        equalCount += copies[j] == states[j];
+      }
+    }
+    ShowRate(aOut, "compare", kRepeatCount * states.size(), start.Since(),
+             "compares");
+    ASSERT(equalCount == kRepeatCount * states.size());
+  }
+  aOut << "\n";
+}
+
+struct GemsetOperands {
+  engine::Gemset mFirst;
+  engine::Gemset mSecond;
+  engine::Gemset mThird;
+};
+
+template <engine::GemsetKernel aKernel>
+static void BenchmarkGemsetKernel(std::ostream& aOut,
+                                  std::vector<GemsetOperands> const& aOperands,
+                                  std::string const& aSuffix) {
+  using engine::Gemset;
+  using Operands = GemsetOperands;
+
+  static std::size_t constexpr kRepeatCount{2000u};
+
+  std::size_t checksum{0u};
+  auto measure = [&](std::string const& aName, auto&& aOperation) {
+    util::TimeStamp start{};
+    for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+      for (auto const& operands : aOperands) {
+        checksum += aOperation(operands);
+      }
+    }
+    ShowRate(aOut, aName + aSuffix, kRepeatCount * aOperands.size(),
+             start.Since(), "ops");
+  };
+
+  measure("Add", [](Operands const& aIn) {
+    return Gemset::Add<aKernel>(aIn.mFirst, aIn.mSecond).Get(0u);
+  });
+  measure("Sub", [](Operands const& aIn) {
+    auto sum = Gemset::Add<aKernel>(aIn.mFirst, aIn.mSecond);
+    return Gemset::Sub<aKernel>(sum, aIn.mSecond).Get(0u);
+  });
+  measure("ApplyDiscount", [](Operands const& aIn) {
+    return Gemset::ApplyDiscount<aKernel>(aIn.mFirst, aIn.mSecond).Get(0u);
+  });
+  measure("GetGoldDemand", [](Operands const& aIn) {
+    return Gemset::GetGoldDemand<aKernel>(aIn.mFirst, aIn.mSecond,
+                                          aIn.mThird);
+  });
+  measure("GetCount", [](Operands const& aIn) {
+    return aIn.mFirst.template GetCount<aKernel>();
+  });
+  measure("Covers", [](Operands const& aIn) {
+    return std::size_t{Gemset::Covers<aKernel>(aIn.mFirst, aIn.mSecond)};
+  });
+
+  std::array<Gemset, 16u> costs{};
+  for (std::size_t i = 0u; i < costs.size(); ++i) {
+    costs[i] = aOperands[i].mThird;
+  }
+  measure("GetAffordableMask x16", [&](Operands const& aIn) {
+    std::array<Gemset, 16u> missing{};
+    return Gemset::GetAffordableMask<16u, aKernel>(
+        Gemset::Add<aKernel>(aIn.mFirst, aIn.mSecond), 3u, costs, missing);
+  });
+  ASSERT(checksum > 0u);
+}
+
+void BenchmarkGemsetKernels(std::ostream& aOut) {
+  static std::size_t constexpr kOperandCount{1024u};
+
+  // Counts below 16 keep every operand of every kernel in range.
+  util::Generator generator{kPositionSeed};
+  auto makeGemset = [&]() {
+    engine::Gemset gems{};
+    for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+      gems.Set(i, generator() % 16u);
+    }
+    return gems;
+  };
+
+  std::vector<GemsetOperands> operands(kOperandCount);
+  for (auto& operand : operands) {
+    operand = {makeGemset(), makeGemset(), makeGemset()};
+  }
+
+  aOut << "--- GEMSET KERNELS ---\n";
+  BenchmarkGemsetKernel<engine::GemsetKernel::kScalar>(aOut, operands,
+                                                       " scalar");
+  BenchmarkGemsetKernel<engine::GemsetKernel::kSwar>(aOut, operands, " SWAR");
+  aOut << "\n";
+}
+
+void BenchmarkDeckDraws(std::ostream& aOut) {
+  static std::size_t constexpr kRepeatCount{200000u};
+  static std::size_t constexpr kDeckSize{engine::CardTable::kLevelCardCount[0]};
+  static uint64 constexpr kFullDeck{(1ull << kDeckSize) - 1u};
+
+  util::Generator generator{kPositionSeed};
+  std::size_t checksum{0u};
+  auto measure = [&](std::string const& aName, auto&& aSelect) {
+    util::TimeStamp start{};
+    for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+      uint64 cards{kFullDeck};
+      for (std::size_t left = kDeckSize; left > 0u; --left) {
+        auto index = aSelect(cards, util::Uniform(generator, left));
+        cards &= ~(1ull << index);
+        checksum += index;
+      }
+    }
+    ShowRate(aOut, aName, kRepeatCount * kDeckSize, start.Since(), "draws");
+  };
+
+  aOut << "--- DECK DRAWS ---\n";
+  // How Deck::Draw used to find the card.
+  measure("listed", [](uint64 aCards, std::size_t aRank) {
+    std::array<uint8, kDeckSize> cards{};
+    uint8 top{0u};
+    util::IterateBitfield(aCards,
+                          [&](std::size_t aIndex) { cards[top++] = aIndex; });
+    return std::size_t{cards[aRank]};
+  });
+  measure("select portable", util::SelectBitPortable);
+#ifdef __BMI2__
+  measure("select PDEP", util::SelectBit);
+#endif
+
+  util::TimeStamp start{};
+  for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+    engine::Deck<kDeckSize, 0u> deck{};
+    std::array<engine::DevelopmentCard, kDeckSize> cards{};
+    deck.DrawMany(cards, generator);
+    checksum += cards.back().GetIndex();
+  }
+  ShowRate(aOut, "Deck::DrawMany", kRepeatCount * kDeckSize, start.Since(),
+           "draws");
+  ASSERT(checksum > 0u);
+  aOut << "\n";
+}
+
+void BenchmarkUcbKernels(std::ostream& aOut) {
+  static std::size_t constexpr kBatchCount{256u};
+  static std::size_t constexpr kRepeatCount{4000u};
+  static std::size_t constexpr kChildCount{engine::MoveList::kCapacity};
+  static float constexpr kExploration{0.8f};
+
+  struct Child {
+    uint32 mRolloutCount;
+    int32 mIntScore;
+    uint32 mAvailable;
+  };
+
+  // Deep nodes: tens of visits spread over a full move set.
+  util::Generator generator{kPositionSeed};
+  std::vector<std::array<Child, kChildCount>> batches(kBatchCount);
+  for (auto& batch : batches) {
+    uint32 available = 20u + util::Uniform(generator, 1000u);
+    for (auto& child : batch) {
+      child.mRolloutCount = 1u + util::Uniform(generator, available);
+      child.mIntScore = static_cast<int32>(util::Uniform(
+                            generator, 2u * child.mRolloutCount)) -
+                        static_cast<int32>(child.mRolloutCount);
+      child.mAvailable = available;
+    }
+  }
+
+  std::size_t checksum{0u};
+  auto measure = [&](std::string const& aName, auto&& aArgMax) {
+    util::TimeStamp start{};
+    for (std::size_t i = 0u; i < kRepeatCount; ++i) {
+      for (auto const& batch : batches) {
+        checksum += aArgMax(batch, i % 2u ? 1.0f : -1.0f);
+      }
+    }
+    ShowRate(aOut, aName, kRepeatCount * kBatchCount * kChildCount,
+             start.Since(), "children");
+  };
+
+  agent::UcbBatch ucb{};
+  auto measureKernel = [&](std::string const& aName, auto aKernel) {
+    measure(aName, [&](auto const& aBatch, float aFactor) {
+      ucb.clear();
+      for (auto const& child : aBatch) {
+        ucb.push_back(child.mRolloutCount, child.mIntScore, child.mAvailable);
+      }
+      return ucb.ArgMax<decltype(aKernel)::value>(aFactor, kExploration);
+    });
+  };
+
+  aOut << "--- UCB KERNELS ---\n";
+  // How Select used to score the children.
+  measure("std::log per child", [](auto const& aBatch, float aFactor) {
+    std::size_t best{0u};
+    float bestValue = std::numeric_limits<float>::lowest();
+    for (std::size_t i = 0u; i < aBatch.size(); ++i) {
+      auto const& child = aBatch[i];
+      float value =
+          aFactor * static_cast<float>(child.mIntScore) / child.mRolloutCount +
+          std::sqrt(kExploration * std::log(child.mAvailable) /
+                    child.mRolloutCount);
+      if (value > bestValue) {
+        best = i;
+        bestValue = value;
+      }
+    }
+    return best;
+  });
+  measureKernel("scalar", std::integral_constant<agent::UcbKernel,
+                                                 agent::UcbKernel::kScalar>{});
+  measureKernel("SIMD", std::integral_constant<agent::UcbKernel,
+                                               agent::UcbKernel::kSimd>{});
+  ASSERT(checksum > 0u);
+  aOut << "\n";
+}
+
+void BenchmarkGenerators(std::ostream& aOut) {
+  static std::size_t constexpr kNumberCount{1u << 26u};
+  // Move counts a rollout picks from.
+  static std::size_t constexpr kBound{37u};
+
+  std::size_t checksum{0u};
+  auto measure = [&](std::string const& aName, auto&& aNext) {
+    util::TimeStamp start{};
+    for (std::size_t i = 0u; i < kNumberCount; ++i) {
+      checksum += aNext();
+    }
+    ShowRate(aOut, aName, kNumberCount, start.Since(), "numbers");
+  };
+
+  std::mt19937 mersenne{kPositionSeed};
+  util::Generator generator{kPositionSeed};
+
+  aOut << "--- GENERATORS ---\n";
+  aOut << std::left << std::setw(24) << "sizeof(std::mt19937)" << std::right
+       << std::setw(14) << sizeof(mersenne) << " bytes\n";
+  aOut << std::left << std::setw(24) << "sizeof(Generator)" << std::right
+       << std::setw(14) << sizeof(generator) << " bytes\n";
+  measure("std::mt19937", [&]() { return mersenne(); });
+  measure("Generator", [&]() { return generator(); });
+  measure("std::mt19937 %", [&]() { return mersenne() % kBound; });
+  measure("Generator %", [&]() { return generator() % kBound; });
+  measure("Generator Uniform",
+          [&]() { return util::Uniform(generator, kBound); });
+  ASSERT(checksum > 0u);
+  aOut << "\n";
+}
+
+}  // namespace test
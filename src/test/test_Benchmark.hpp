@@ -0,0 +1,68 @@
+#ifndef TEST_BENCHMARK_HPP
+#define TEST_BENCHMARK_HPP
+
+#include <iostream>
+
+#include "util_General.hpp"
+
+namespace test {
+
+void RunBenchmarks(std::ostream& aOut);
+
+/* Depth and rollouts/sec of single threaded, root parallel and tree parallel
+ * search from the same positions. */
+void BenchmarkSearchParallelism(std::ostream& aOut, std::size_t aThreadCount,
+                                float aSeconds);
+
+/* Rollouts, state nodes and rollouts per state node of single threaded
+ * search from the same positions, without and with transpositions. */
+void BenchmarkTranspositions(std::ostream& aOut, float aSeconds);
+
+/* Rollouts per second, nodes and bytes per node of single threaded search
+ * from the same positions. */
+void BenchmarkTreeMemory(std::ostream& aOut, float aSeconds);
+
+/* Iterations per second and mean depth of single threaded search from the
+ * same positions, with every rollout cut at once for the static evaluation
+ * so the tree alone sets the pace: at full width and with progressive
+ * widening, determinizing every node or once per iteration. */
+void BenchmarkTreeIterations(std::ostream& aOut, float aSeconds);
+
+/* Rollouts per second of single threaded search from the same positions,
+ * playing rollouts to the end and cutting them at aMaxPlyCount plies, then
+ * the record of the cut search in aGameCount games against the full one at
+ * aSeconds per move. */
+void BenchmarkRolloutCutoff(std::ostream& aOut, std::size_t aMaxPlyCount,
+                            std::size_t aGameCount, float aSeconds);
+
+/* Plies per second of rollout games from the benchmark positions, in
+ * batches of aBatchSize, for each rollout policy: one game after the other
+ * through Runner::RunGame and in lockstep through RunRollouts. */
+void BenchmarkRollouts(std::ostream& aOut, std::size_t aBatchSize);
+
+/* Moves generated per second into a fresh vector and into a MoveList, plus
+ * heap allocations per rollout game with COUNT_ALLOCATIONS. */
+void BenchmarkMoveGeneration(std::ostream& aOut);
+
+/* sizeof(GameState), plus copies and comparisons per second over states
+ * taken from rollout games. */
+void BenchmarkStateCopies(std::ostream& aOut);
+
+/* Operations per second of each Gemset kernel, scalar and SWAR. */
+void BenchmarkGemsetKernels(std::ostream& aOut);
+
+/* Cards drawn per second from a full level 0 deck until it is empty, by
+ * listing the cards left and by selecting the drawn bit. */
+void BenchmarkDeckDraws(std::ostream& aOut);
+
+/* State size and numbers per second of std::mt19937 and util::Generator,
+ * raw and bounded by a modulo or by util::Uniform. */
+void BenchmarkGenerators(std::ostream& aOut);
+
+/* Children scored per second by UCB argmax: the old per child std::log
+ * loop, then UcbBatch with its scalar and SIMD kernels. */
+void BenchmarkUcbKernels(std::ostream& aOut);
+
+}  // namespace test
+
+#endif  // TEST_BENCHMARK_HPP
@@ -0,0 +1,669 @@
+#include "test_Check.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "agent_MonteCarloTreeSearch.hpp"
+#include "agent_SmartRollout.hpp"
+#include "agent_UcbBatch.hpp"
+#include "engine_DevelopmentCard.hpp"
+#include "engine_GameState.hpp"
+#include "engine_Gemset.hpp"
+#include "engine_Move.hpp"
+#include "engine_MoveList.hpp"
+#include "engine_MoveTable.hpp"
+#include "util_General.hpp"
+
+namespace test {
+
+using engine::Color;
+using engine::Gemset;
+using engine::GemsetKernel;
+using engine::Move;
+
+/* Gems of one color in the bank of a two player game. */
+static std::size_t constexpr kMaxColorCount{4u};
+static std::size_t constexpr kMaxGoldCount{5u};
+static std::size_t constexpr kMaxGemCount{10u};
+
+template <class Visit>
+static void ForEachGemset(std::size_t aMaxCount, Visit&& aVisit) {
+  std::size_t const base = aMaxCount + 1u;
+  std::size_t combinations = 1u;
+  for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+    combinations *= base;
+  }
+
+  for (std::size_t code = 0u; code < combinations; ++code) {
+    Gemset gems{};
+    for (std::size_t i = 0u, rest = code; i < engine::kGemColorCount;
+         ++i, rest /= base) {
+      gems.Set(i, rest % base);
+    }
+    aVisit(gems);
+  }
+}
+
+/* The loops GameState::GetCollectMoves used before the move table. */
+static std::vector<Move> GetCollectMoves(Gemset const& aAvailable) {
+  std::vector<Move> moves{};
+
+  std::size_t maxCollectCount{0u};
+  for (size_t i = 0u; i < engine::kGemColorCount; ++i) {
+    if (aAvailable.Get(i) > 0) {
+      maxCollectCount++;
+    }
+  }
+  maxCollectCount =
+      std::min(maxCollectCount, engine::MoveTable::kMaxCollectCount);
+
+  std::size_t W = std::min(1ul, aAvailable.Get(Color::kWhite));
+  std::size_t U = std::min(1ul, aAvailable.Get(Color::kBlue));
+  std::size_t G = std::min(1ul, aAvailable.Get(Color::kGreen));
+  std::size_t R = std::min(1ul, aAvailable.Get(Color::kRed));
+  std::size_t B = std::min(1ul, aAvailable.Get(Color::kBlack));
+
+  for (std::size_t w = 0u; w <= std::min(W, maxCollectCount); ++w) {
+    for (std::size_t u = 0u; u <= std::min(U, maxCollectCount - w); ++u) {
+      for (std::size_t g = 0u; g <= std::min(G, maxCollectCount - w - u);
+           ++g) {
+        for (std::size_t r = 0u; r <= std::min(R, maxCollectCount - w - u - g);
+             ++r) {
+          for (std::size_t b = 0u;
+               b <= std::min(B, maxCollectCount - w - u - g - r); ++b) {
+            if (w + u + g + r + b == maxCollectCount) {
+              moves.emplace_back(Move::MakeCollectMove(Gemset(w, u, g, r, b)));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+    if (aAvailable.Get(i) >= 4) {
+      Gemset take{};
+      take.Set(i, 2u);
+      moves.emplace_back(Move::MakeCollectMove(take));
+    }
+  }
+
+  return moves;
+}
+
+/* The loops GameState::GetReturnMoves used before the move table. */
+static std::vector<Move> GetReturnMoves(Gemset const& aHeld,
+                                        std::size_t aReturnCount) {
+  std::vector<Move> moves{};
+
+  std::size_t W = aHeld.Get(Color::kWhite);
+  std::size_t U = aHeld.Get(Color::kBlue);
+  std::size_t G = aHeld.Get(Color::kGreen);
+  std::size_t R = aHeld.Get(Color::kRed);
+  std::size_t B = aHeld.Get(Color::kBlack);
+
+  for (std::size_t w = 0u; w <= std::min(W, aReturnCount); ++w) {
+    for (std::size_t u = 0u; u <= std::min(U, aReturnCount - w); ++u) {
+      for (std::size_t g = 0u; g <= std::min(G, aReturnCount - w - u); ++g) {
+        for (std::size_t r = 0u; r <= std::min(R, aReturnCount - w - u - g);
+             ++r) {
+          for (std::size_t b = 0u;
+               b <= std::min(B, aReturnCount - w - u - g - r); ++b) {
+            if (w + u + g + r + b == aReturnCount) {
+              moves.emplace_back(Move::MakeReturnMove(Gemset(w, u, g, r, b)));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  return moves;
+}
+
+static bool IsEqual(std::vector<Move> const& aExpected,
+                    engine::MoveList const& aActual) {
+  return std::equal(aExpected.begin(), aExpected.end(), aActual.begin(),
+                    aActual.end());
+}
+
+/* The bit util::SelectBit should find, one set bit at a time. */
+static std::size_t SelectBitReference(uint64 aBits, std::size_t aRank) {
+  for (std::size_t i = 0u; i < 64u; ++i) {
+    if (aBits & (1ull << i)) {
+      if (aRank == 0u) {
+        return i;
+      }
+      aRank--;
+    }
+  }
+
+  ASSERT_ALWAYS();
+  return 64u;
+}
+
+/* Wilson-Hilferty approximation of the chi-square quantile at p = 0.999. */
+static double GetChiSquareLimit(std::size_t aDegrees) {
+  double const c = 2.0 / (9.0 * aDegrees);
+  return aDegrees * std::pow(1.0 - c + 3.09 * std::sqrt(c), 3.0);
+}
+
+/* Counts the failed inputs of CheckDeckDraws for decks of aDeckSize cards. */
+template <std::size_t aDeckSize>
+static std::size_t CheckDeck(std::size_t aTrialCount,
+                             util::Generator& aGenerator,
+                             std::size_t& aInputCount) {
+  using engine::DevelopmentCard;
+
+  static std::size_t constexpr kDrawCount{3u};
+
+  std::size_t failureCount{0u};
+  std::array<std::array<std::size_t, aDeckSize>, kDrawCount> counts{};
+  for (std::size_t trial = 0u; trial < aTrialCount; ++trial) {
+    engine::Deck<aDeckSize, 0u> deck{};
+    std::array<DevelopmentCard, kDrawCount> cards{};
+    cards[0] = deck.Draw(aGenerator);
+    deck.DrawMany({cards.data() + 1u, kDrawCount - 1u}, aGenerator);
+
+    aInputCount++;
+    bool failed = false;
+    for (std::size_t i = 0u; i < kDrawCount; ++i) {
+      failed |= !cards[i] || cards[i].GetIndex() >= aDeckSize;
+      for (std::size_t j = 0u; j < i; ++j) {
+        failed |= cards[i].GetIndex() == cards[j].GetIndex();
+      }
+      if (!failed) {
+        counts[i][cards[i].GetIndex()]++;
+      }
+    }
+    failureCount += failed;
+  }
+
+  double const expected = static_cast<double>(aTrialCount) / aDeckSize;
+  for (auto const& positionCounts : counts) {
+    double chiSquare{0.0};
+    for (auto count : positionCounts) {
+      chiSquare += (count - expected) * (count - expected) / expected;
+    }
+    aInputCount++;
+    failureCount += chiSquare > GetChiSquareLimit(aDeckSize - 1u);
+  }
+
+  // Emptying the deck hands out every card once, then invalid ones.
+  engine::Deck<aDeckSize, 0u> deck{};
+  std::array<DevelopmentCard, aDeckSize + 1u> cards{};
+  deck.DrawMany(cards, aGenerator);
+  uint64 seen{0u};
+  for (std::size_t i = 0u; i < aDeckSize; ++i) {
+    seen |= cards[i] ? 1ull << cards[i].GetIndex() : 0u;
+  }
+  aInputCount++;
+  failureCount += std::popcount(seen) != aDeckSize || cards.back() ||
+                  deck.HasCard();
+
+  return failureCount;
+}
+
+bool RunChecks(std::ostream& aOut) {
+  bool passed = true;
+  passed &= CheckMoveTables(aOut);
+  passed &= CheckGemsetKernels(aOut);
+  passed &= CheckDeckDraws(aOut);
+  passed &= CheckUniformDraws(aOut);
+  passed &= CheckStateHashes(aOut);
+  passed &= CheckMoveKeys(aOut);
+  passed &= CheckUcbKernels(aOut);
+  passed &= CheckSearchBudgets(aOut);
+  return passed;
+}
+
+bool CheckMoveTables(std::ostream& aOut) {
+  using engine::MoveTable;
+
+  std::size_t inputCount{0u};
+  std::size_t failureCount{0u};
+  engine::MoveList moves{};
+
+  ForEachGemset(kMaxColorCount, [&](Gemset const& aAvailable) {
+    moves.clear();
+    moves.append(MoveTable::GetCollectMoves(MoveTable::GetColorMask(
+        aAvailable, [](std::size_t aCount) { return aCount > 0u; })));
+    moves.append(MoveTable::GetCollectTwoMoves(MoveTable::GetColorMask(
+        aAvailable, [](std::size_t aCount) { return aCount >= 4u; })));
+
+    inputCount++;
+    failureCount += !IsEqual(GetCollectMoves(aAvailable), moves);
+  });
+
+  ForEachGemset(kMaxColorCount, [&](Gemset const& aHeld) {
+    for (std::size_t gold = 0u; gold <= kMaxGoldCount; ++gold) {
+      std::size_t gemCount = aHeld.GetCount() + gold;
+      if (gemCount <= kMaxGemCount ||
+          gemCount - kMaxGemCount > MoveTable::kMaxReturnCount) {
+        continue;
+      }
+
+      moves.clear();
+      MoveTable::GetReturnMoves(aHeld, gemCount - kMaxGemCount, moves);
+
+      inputCount++;
+      failureCount +=
+          !IsEqual(GetReturnMoves(aHeld, gemCount - kMaxGemCount), moves);
+    }
+  });
+
+  aOut << "move tables: " << inputCount << " inputs, " << failureCount
+       << " failures\n";
+  return failureCount == 0u;
+}
+
+bool CheckGemsetKernels(std::ostream& aOut) {
+  static std::size_t constexpr kLimit{32u};
+  static std::size_t constexpr kPairCount{kLimit * kLimit};
+
+  std::size_t inputCount{0u};
+  std::size_t failureCount{0u};
+
+  for (std::size_t w = 0u; w < kLimit; ++w) {
+    for (std::size_t u = 0u; u < kLimit; ++u) {
+      for (std::size_t g = 0u; g < kLimit; ++g) {
+        for (std::size_t r = 0u; r < kLimit; ++r) {
+          for (std::size_t b = 0u; b < kLimit; ++b) {
+            Gemset gems{w, u, g, r, b};
+            inputCount++;
+            failureCount += gems.GetCount<GemsetKernel::kScalar>() !=
+                            gems.GetCount<GemsetKernel::kSwar>();
+          }
+        }
+      }
+    }
+  }
+
+  // Lane 0 walks through every pair of counts, the other lanes through the
+  // same pairs in other orders, once per offset.
+  for (std::size_t offset = 0u; offset < kPairCount; ++offset) {
+    for (std::size_t pair = 0u; pair < kPairCount; ++pair) {
+      Gemset left{};
+      Gemset right{};
+      for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+        std::size_t lanePair = (pair * (2u * i + 1u) + i * offset) % kPairCount;
+        left.Set(i, lanePair / kLimit);
+        right.Set(i, lanePair % kLimit);
+      }
+
+      Gemset high{};
+      Gemset low{};
+      Gemset halfLeft{};
+      Gemset halfRight{};
+      for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+        high.Set(i, std::max(left.Get(i), right.Get(i)));
+        low.Set(i, std::min(left.Get(i), right.Get(i)));
+        halfLeft.Set(i, left.Get(i) / 2u);
+        halfRight.Set(i, right.Get(i) / 2u);
+      }
+
+      inputCount++;
+      failureCount += Gemset::Add<GemsetKernel::kScalar>(left, right) !=
+                      Gemset::Add<GemsetKernel::kSwar>(left, right);
+      failureCount += Gemset::Sub<GemsetKernel::kScalar>(high, low) !=
+                      Gemset::Sub<GemsetKernel::kSwar>(high, low);
+      failureCount +=
+          Gemset::ApplyDiscount<GemsetKernel::kScalar>(left, right) !=
+          Gemset::ApplyDiscount<GemsetKernel::kSwar>(left, right);
+      failureCount += Gemset::Covers<GemsetKernel::kScalar>(left, right) !=
+                      Gemset::Covers<GemsetKernel::kSwar>(left, right);
+      failureCount +=
+          Gemset::GetGoldDemand<GemsetKernel::kScalar>(halfLeft, halfRight,
+                                                       right) !=
+          Gemset::GetGoldDemand<GemsetKernel::kSwar>(halfLeft, halfRight,
+                                                     right);
+    }
+  }
+
+  static std::size_t constexpr kBatchCount{1u << 16u};
+  static std::size_t constexpr kBatchSize{16u};
+
+  util::Generator generator{1u};
+  auto makeGemset = [&](std::size_t aLimit) {
+    Gemset gems{};
+    for (std::size_t i = 0u; i < engine::kGemColorCount; ++i) {
+      gems.Set(i, generator() % aLimit);
+    }
+    return gems;
+  };
+
+  for (std::size_t batch = 0u; batch < kBatchCount; ++batch) {
+    std::array<Gemset, kBatchSize> costs{};
+    for (auto& cost : costs) {
+      cost = makeGemset(8u);
+    }
+    auto power = makeGemset(kLimit);
+    std::size_t gold = generator() % 8u;
+
+    std::array<Gemset, kBatchSize> scalarMissing{};
+    std::array<Gemset, kBatchSize> swarMissing{};
+    auto scalarMask =
+        Gemset::GetAffordableMask<kBatchSize, GemsetKernel::kScalar>(
+            power, gold, costs, scalarMissing);
+    auto swarMask = Gemset::GetAffordableMask<kBatchSize, GemsetKernel::kSwar>(
+        power, gold, costs, swarMissing);
+
+    inputCount++;
+    failureCount += scalarMask != swarMask || scalarMissing != swarMissing;
+  }
+
+  aOut << "gemset kernels: " << inputCount << " inputs, " << failureCount
+       << " failures\n";
+  return failureCount == 0u;
+}
+
+bool CheckDeckDraws(std::ostream& aOut) {
+  static std::size_t constexpr kWordCount{1u << 16u};
+  static std::size_t constexpr kTrialCount{100000u};
+
+  std::size_t inputCount{0u};
+  std::size_t failureCount{0u};
+
+  util::Generator generator{1u};
+  for (std::size_t i = 0u; i < kWordCount; ++i) {
+    // Thin some words out so sparse ones show up too.
+    uint64 word = (uint64{generator()} << 32u) | generator();
+    for (std::size_t j = 0u; j < i % 4u; ++j) {
+      word &= (uint64{generator()} << 32u) | generator();
+    }
+
+    auto count = static_cast<std::size_t>(std::popcount(word));
+    for (std::size_t rank = 0u; rank < count; ++rank) {
+      auto expected = SelectBitReference(word, rank);
+      inputCount++;
+      failureCount += util::SelectBit(word, rank) != expected ||
+                      util::SelectBitPortable(word, rank) != expected;
+    }
+  }
+
+  using engine::CardTable;
+  failureCount += CheckDeck<CardTable::kLevelCardCount[0]>(
+      kTrialCount, generator, inputCount);
+  failureCount += CheckDeck<CardTable::kLevelCardCount[2]>(
+      kTrialCount, generator, inputCount);
+
+  aOut << "deck draws: " << inputCount << " inputs, " << failureCount
+       << " failures\n";
+  return failureCount == 0u;
+}
+
+bool CheckUniformDraws(std::ostream& aOut) {
+  static std::size_t constexpr kMaxBound{64u};
+  static std::size_t constexpr kDrawsPerValue{2000u};
+  static std::size_t constexpr kStreamCount{8u};
+
+  std::size_t inputCount{0u};
+  std::size_t failureCount{0u};
+
+  util::Generator generator{1u};
+  for (std::size_t bound = 2u; bound <= kMaxBound; ++bound) {
+    std::array<std::size_t, kMaxBound> counts{};
+    for (std::size_t i = 0u; i < bound * kDrawsPerValue; ++i) {
+      auto value = util::Uniform(generator, bound);
+      failureCount += value >= bound;
+      counts[std::min(value, kMaxBound - 1u)]++;
+    }
+
+    double chiSquare{0.0};
+    for (std::size_t value = 0u; value < bound; ++value) {
+      double offset = counts[value] - static_cast<double>(kDrawsPerValue);
+      chiSquare += offset * offset / kDrawsPerValue;
+    }
+    inputCount++;
+    failureCount += chiSquare > GetChiSquareLimit(bound - 1u);
+  }
+
+  std::vector<uint64> firsts{};
+  for (std::size_t stream = 0u; stream < kStreamCount; ++stream) {
+    auto streamGenerator = util::MakeGenerator(1u, stream);
+    firsts.push_back(streamGenerator());
+  }
+  std::sort(firsts.begin(), firsts.end());
+  inputCount++;
+  failureCount += std::adjacent_find(firsts.begin(), firsts.end()) !=
+                  firsts.end();
+
+  aOut << "uniform draws: " << inputCount << " inputs, " << failureCount
+       << " failures\n";
+  return failureCount == 0u;
+}
+
+bool CheckStateHashes(std::ostream& aOut) {
+  static std::size_t constexpr kGameCount{500u};
+
+  std::size_t inputCount{0u};
+  std::size_t failureCount{0u};
+  // The first state seen for each hash: with 64 bits none of the states
+  // these games reach should share one.
+  std::unordered_map<uint64, engine::GameState> seen{};
+  auto check = [&](engine::GameState const& aState) {
+    inputCount++;
+    failureCount += aState.GetHash() != aState.ComputeHash();
+    auto [it, inserted] = seen.try_emplace(aState.GetHash(), aState);
+    failureCount +=
+        !inserted && 0 != memcmp(&it->second, &aState, sizeof(aState));
+
+    auto const& players = aState.GetPlayers();
+    failureCount += aState.GetAvailable() !=
+                    Gemset::Sub(Gemset{4u}, Gemset::Add(players[0].GetHeld(),
+                                                        players[1].GetHeld()));
+  };
+
+  util::Generator generator{1u};
+  agent::SmartRollout policy{generator};
+  for (std::size_t i = 0u; i < kGameCount; ++i) {
+    engine::GameState state{generator};
+    check(state);
+    while (!state.IsTerminal()) {
+      auto masked = state.MaskHiddenInformation(1u - state.GetNextPlayer());
+      check(masked);
+      inputCount++;
+      failureCount +=
+          state.GetMaskedHash(1u - state.GetNextPlayer()) != masked.GetHash();
+      masked.Determinize(generator);
+      check(masked);
+
+      state.DoMove(policy.OnTurn(state.MaskHiddenInformation()), generator);
+      check(state);
+    }
+  }
+
+  aOut << "state hashes: " << inputCount << " inputs, " << failureCount
+       << " failures\n";
+  return failureCount == 0u;
+}
+
+bool CheckMoveKeys(std::ostream& aOut) {
+  static std::size_t constexpr kGameCount{200u};
+
+  std::size_t inputCount{0u};
+  std::size_t failureCount{0u};
+
+  util::Generator generator{1u};
+  agent::SmartRollout policy{generator};
+  for (std::size_t i = 0u; i < kGameCount; ++i) {
+    engine::GameState state{generator};
+    engine::MoveList previous{};
+    while (!state.IsTerminal()) {
+      engine::MoveList moves{};
+      state.GetMoves(moves);
+
+      // Neighbouring states share most of their moves, so this pairs equal
+      // moves as well as different ones.
+      for (auto const& move : moves) {
+        for (auto const& other : previous) {
+          inputCount++;
+          failureCount += (move.GetKey() == other.GetKey()) != (move == other);
+        }
+        for (auto const& other : moves) {
+          inputCount++;
+          failureCount += (move.GetKey() == other.GetKey()) != (move == other);
+        }
+      }
+
+      previous = moves;
+      state.DoMove(policy.OnTurn(state.MaskHiddenInformation()), generator);
+    }
+  }
+
+  aOut << "move keys: " << inputCount << " inputs, " << failureCount
+       << " failures\n";
+  return failureCount == 0u;
+}
+
+bool CheckUcbKernels(std::ostream& aOut) {
+  static std::size_t constexpr kBatchCount{100000u};
+  static float constexpr kExploration{0.8f};
+
+  std::size_t inputCount{0u};
+  std::size_t failureCount{0u};
+
+  util::Generator generator{1u};
+  agent::UcbBatch batch{};
+  for (std::size_t i = 0u; i < kBatchCount; ++i) {
+    // Small and large counts, and runs of equal children to test that ties
+    // go to the first.
+    uint32 scale = util::Uniform(generator, 2u) ? 100u : 1000000u;
+    std::size_t size =
+        1u + util::Uniform(generator, agent::UcbBatch::kCapacity);
+    uint32 available = 1u + util::Uniform(generator, scale);
+    uint32 rolloutCount{1u};
+    int32 intScore{0};
+
+    batch.clear();
+    for (std::size_t j = 0u; j < size; ++j) {
+      if (j == 0u || util::Uniform(generator, 4u) != 0u) {
+        rolloutCount = 1u + util::Uniform(generator, available);
+        intScore = static_cast<int32>(util::Uniform(generator, 2u * scale)) -
+                   static_cast<int32>(scale);
+      }
+      batch.push_back(rolloutCount, intScore, available);
+      available += util::Uniform(generator, 2u);
+    }
+
+    for (float factor : {1.0f, -1.0f}) {
+      inputCount++;
+      failureCount +=
+          batch.ArgMax<agent::UcbKernel::kSimd>(factor, kExploration) !=
+          batch.ArgMax<agent::UcbKernel::kScalar>(factor, kExploration);
+    }
+  }
+
+  for (uint32 count = 1u; count < 10000u; ++count) {
+    double log = std::log(static_cast<double>(count));
+    inputCount++;
+    failureCount += std::abs(agent::UcbBatch::GetLog(count) - log) > 1e-6 * log;
+  }
+
+  aOut << "ucb kernels: " << inputCount << " inputs, " << failureCount
+       << " failures\n";
+  return failureCount == 0u;
+}
+
+/* One search turn of PlaySearchGame. */
+struct SearchTurn {
+  Move mMove{};
+  std::size_t mRolloutCount{0u};
+  std::size_t mPlayedRolloutCount{0u};
+  std::size_t mNodeCount{0u};
+  std::size_t mAddedNodeCount{0u};
+
+  bool operator==(SearchTurn const& aOther) const = default;
+};
+
+/* A game between two searches with aOptions, from a fixed start. The
+ * searches get a generator of their own with a random seed. */
+static std::vector<SearchTurn> PlaySearchGame(
+    agent::MonteCarloTreeSearch::Options const& aOptions) {
+  util::Generator generator{1u};
+  engine::GameState state{generator};
+
+  util::Generator searchGenerator = util::MakeGenerator();
+  std::array<std::unique_ptr<agent::MonteCarloTreeSearch>, 2u> searches{};
+  for (uint8 player = 0u; player < searches.size(); ++player) {
+    searches[player] = std::make_unique<agent::MonteCarloTreeSearch>(
+        searchGenerator, aOptions);
+    searches[player]->OnSetup(state, player);
+  }
+
+  std::vector<SearchTurn> turns{};
+  while (!state.IsTerminal()) {
+    auto& search = *searches[state.GetNextPlayer()];
+    Move move = search.OnTurn(state.MaskHiddenInformation());
+    auto const& statistics = search.GetStatistics();
+    turns.push_back(SearchTurn{move, statistics.mRolloutCount,
+                               statistics.mPlayedRolloutCount,
+                               statistics.mNodeCount,
+                               statistics.mAddedNodeCount});
+    state.DoMove(move, generator);
+  }
+  return turns;
+}
+
+bool CheckSearchBudgets(std::ostream& aOut) {
+  using Options = agent::MonteCarloTreeSearch::Options;
+  static std::size_t constexpr kIterationBudget{50u};
+  static std::size_t constexpr kRolloutBudget{248u};
+  static std::size_t constexpr kNodeBudget{2000u};
+  static std::size_t constexpr kLeafCacheSize{1u << 12u};
+
+  Options options{};
+  options.mTimeoutSeconds = std::numeric_limits<float>::infinity();
+  options.mSeed = 1u;
+
+  std::size_t inputCount{0u};
+  std::size_t failureCount{0u};
+  auto check = [&](Options const& aOptions, auto&& aWithinBudget) {
+    auto turns = PlaySearchGame(aOptions);
+    auto again = PlaySearchGame(aOptions);
+    inputCount += turns.size();
+    failureCount += turns.size() != again.size();
+    for (std::size_t i = 0u; i < std::min(turns.size(), again.size()); ++i) {
+      failureCount += !(turns[i] == again[i]) || !aWithinBudget(turns[i]);
+    }
+  };
+
+  std::size_t sims = options.mSimsPerRollout;
+  Options iterations = options;
+  iterations.mIterationBudget = kIterationBudget;
+  check(iterations, [&](SearchTurn const& aTurn) {
+    return aTurn.mRolloutCount == kIterationBudget * sims;
+  });
+
+  // Terminal leaves and those the leaf cache answers play no rollouts, so
+  // a search may instead run out of iterations, one per budgeted rollout.
+  auto withinRollouts = [&](SearchTurn const& aTurn) {
+    return aTurn.mPlayedRolloutCount < kRolloutBudget + sims &&
+           (aTurn.mPlayedRolloutCount >= kRolloutBudget ||
+            aTurn.mRolloutCount == kRolloutBudget * sims);
+  };
+  Options rollouts = options;
+  rollouts.mRolloutBudget = kRolloutBudget;
+  check(rollouts, withinRollouts);
+  rollouts.mLeafCacheSize = kLeafCacheSize;
+  check(rollouts, withinRollouts);
+
+  Options nodes = options;
+  nodes.mNodeBudget = kNodeBudget;
+  check(nodes, [&](SearchTurn const& aTurn) {
+    return aTurn.mAddedNodeCount <= kNodeBudget;
+  });
+
+  aOut << "search budgets: " << inputCount << " inputs, " << failureCount
+       << " failures\n";
+  return failureCount == 0u;
+}
+
+}  // namespace test
@@ -0,0 +1,52 @@
+#ifndef TEST_CHECK_HPP
+#define TEST_CHECK_HPP
+
+#include <iostream>
+
+namespace test {
+
+/* Runs every check below, returns false if any of them failed. */
+bool RunChecks(std::ostream& aOut);
+
+/* Compares the precomputed collect and return moves with the nested loops
+ * they replaced, for every gem count a two player game can reach. */
+bool CheckMoveTables(std::ostream& aOut);
+
+/* Compares the SWAR Gemset kernels with the scalar loops: every count below
+ * 32 for GetCount, every pair of counts below 32 in every lane for the
+ * others, random batches for GetAffordableMask. */
+bool CheckGemsetKernels(std::ostream& aOut);
+
+/* Compares SelectBit with clearing the low bits one by one on random words,
+ * then draws three cards at a time from fresh decks of both storage sizes
+ * and tests that every draw position is uniform over the deck. */
+bool CheckDeckDraws(std::ostream& aOut);
+
+/* Tests that util::Uniform is uniform for every bound up to 64 and that the
+ * per thread streams of one seed differ. */
+bool CheckUniformDraws(std::ostream& aOut);
+
+/* Compares the incremental GameState hash with a full recompute after every
+ * move of rollout games, and after masking and determinizing each state,
+ * and GetMaskedHash with the hash of the masked state. Also fails on two
+ * different states sharing a hash, or on a bank that does not hold the
+ * gems the players do not. */
+bool CheckStateHashes(std::ostream& aOut);
+
+/* Tests that Move::GetKey tells moves apart exactly as operator== does, on
+ * the moves of rollout game states and of the states before them. */
+bool CheckMoveKeys(std::ostream& aOut);
+
+/* Compares the SIMD UCB argmax with the scalar loop on random batches of
+ * children, and the log table with std::log. */
+bool CheckUcbKernels(std::ostream& aOut);
+
+/* Plays games between seeded single threaded searches with no timeout, once
+ * for each of the iteration, rollout and node budgets, and tests that every
+ * game plays twice the same, with the rollouts or the added nodes the budget
+ * allows. */
+bool CheckSearchBudgets(std::ostream& aOut);
+
+}  // namespace test
+
+#endif  // TEST_CHECK_HPP
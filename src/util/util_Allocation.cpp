@@ -0,0 +1,62 @@
+#include "util_Allocation.hpp"
+
+#include <cstdlib>
+#include <new>
+
+#if COUNT_ALLOCATIONS
+static thread_local std::size_t tAllocationCount{0u};
+
+namespace util {
+
+std::size_t GetAllocationCount() { return tAllocationCount; }
+
+}  // namespace util
+
+void* operator new(std::size_t aSize) {
+  tAllocationCount++;
+  if (void* pointer = std::malloc(aSize == 0u ? 1u : aSize)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t aSize, std::nothrow_t const&) noexcept {
+  tAllocationCount++;
+  return std::malloc(aSize == 0u ? 1u : aSize);
+}
+
+void operator delete(void* aPointer) noexcept { std::free(aPointer); }
+
+void operator delete(void* aPointer, std::size_t) noexcept {
+  std::free(aPointer);
+}
+
+void operator delete(void* aPointer, std::nothrow_t const&) noexcept {
+  std::free(aPointer);
+}
+
+void* operator new(std::size_t aSize, std::align_val_t aAlignment) {
+  tAllocationCount++;
+  std::size_t alignment = static_cast<std::size_t>(aAlignment);
+  std::size_t size = (aSize + alignment - 1u) / alignment * alignment;
+  if (void* pointer =
+          std::aligned_alloc(alignment, size == 0u ? alignment : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* aPointer, std::align_val_t) noexcept {
+  std::free(aPointer);
+}
+
+void operator delete(void* aPointer, std::size_t, std::align_val_t) noexcept {
+  std::free(aPointer);
+}
+#else
+namespace util {
+
+std::size_t GetAllocationCount() { return 0u; }
+
+}  // namespace util
+#endif  // COUNT_ALLOCATIONS
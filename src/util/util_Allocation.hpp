@@ -0,0 +1,21 @@
+#ifndef UTIL_ALLOCATION_HPP
+#define UTIL_ALLOCATION_HPP
+
+#include "util_General.hpp"
+
+/* Replaces the global operator new to count allocations, at the cost of a
+ * thread local increment on each. Set by the CMake option of that name. */
+#ifndef COUNT_ALLOCATIONS
+#define COUNT_ALLOCATIONS 0
+#endif
+
+namespace util {
+
+/* Number of heap allocations made by the calling thread so far. Counted by
+ * the global operator new replacement in util_Allocation.cpp, always zero
+ * without COUNT_ALLOCATIONS. */
+std::size_t GetAllocationCount();
+
+}  // namespace util
+
+#endif  // UTIL_ALLOCATION_HPP
@@ -1,12 +1,18 @@
 #ifndef UTIL_GENERAL_HPP
 #define UTIL_GENERAL_HPP
 
+#include <array>
+#include <bit>
 #include <cstdint>
 #include <functional>
 #include <limits>
 #include <random>
 #include <stdexcept>
 
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 #define __stringize(a) #a
 #define stringize(a) __stringize(a)
 
@@ -27,6 +33,7 @@ typedef std::uint32_t uint32;
 typedef std::uint16_t uint16;
 typedef std::uint8_t uint8;
 typedef std::uint64_t uint64;
+typedef std::int32_t int32;
 
 namespace util {
 
@@ -56,37 +63,180 @@ inline void IterateBitfield(Storage bitfield, Callable&& callable) {
   }
 }
 
-using Generator = std::mt19937;
+/* Position of the set bit with rank r in byte b at [r][b], 8 past the end
+ * when b has r or fewer bits. */
+inline constexpr auto kSelectInByte = []() {
+  std::array<std::array<uint8, 256u>, 8u> table{};
+  for (std::size_t byte = 0u; byte < 256u; ++byte) {
+    std::size_t rank{0u};
+    for (std::size_t bit = 0u; bit < 8u; ++bit) {
+      if (byte & (1u << bit)) {
+        table[rank++][byte] = bit;
+      }
+    }
+    for (; rank < 8u; ++rank) {
+      table[rank][byte] = 8u;
+    }
+  }
+  return table;
+}();
+
+/* SelectBit without BMI2. Multiplying the per byte counts sums them into
+ * running totals, the totals at most aRank give the byte and kSelectInByte
+ * the bit inside it. */
+inline std::size_t SelectBitPortable(uint64 aBits, std::size_t aRank) {
+  static uint64 constexpr kOnes{0x0101010101010101ull};
+  static uint64 constexpr kHighs{0x8080808080808080ull};
+
+  uint64 counts = aBits - ((aBits >> 1u) & 0x5555555555555555ull);
+  counts = (counts & 0x3333333333333333ull) +
+           ((counts >> 2u) & 0x3333333333333333ull);
+  counts = (counts + (counts >> 4u)) & 0x0F0F0F0F0F0F0F0Full;
+  uint64 totals = counts * kOnes;
+
+  uint64 below = ((aRank * kOnes | kHighs) - totals) & kHighs;
+  std::size_t offset = ((below >> 7u) * kOnes) >> 53u;
+  aRank -= ((totals << 8u) >> offset) & 0xFFu;
+
+  return offset + kSelectInByte[aRank][(aBits >> offset) & 0xFFu];
+}
 
+/* Position of the set bit with aRank set bits below it, a single PDEP when
+ * the target has BMI2. */
+inline std::size_t SelectBit(uint64 aBits, std::size_t aRank) {
+  ASSERT(aRank < static_cast<std::size_t>(std::popcount(aBits)));
+#ifdef __BMI2__
+  return __builtin_ctzll(_pdep_u64(1ull << aRank, aBits));
+#else
+  return SelectBitPortable(aBits, aRank);
+#endif
+}
+
+/* xoshiro256** by Blackman and Vigna: 32 bytes of state where std::mt19937
+ * keeps 2.5 KB, and a few shifts and rotates per number. Seeds go through
+ * SplitMix64 so that nearby seeds give unrelated states. */
+class Xoshiro256 {
+ public:
+  using result_type = uint64;
+
+  constexpr Xoshiro256() : Xoshiro256(0u) {}
+  explicit constexpr Xoshiro256(uint64 aSeed) {
+    for (auto& word : mState) {
+      aSeed += 0x9E3779B97F4A7C15ull;
+      uint64 mixed = aSeed;
+      mixed = (mixed ^ (mixed >> 30u)) * 0xBF58476D1CE4E5B9ull;
+      mixed = (mixed ^ (mixed >> 27u)) * 0x94D049BB133111EBull;
+      word = mixed ^ (mixed >> 31u);
+    }
+  }
+
+  static constexpr result_type min() { return 0u; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  constexpr result_type operator()() {
+    uint64 result = std::rotl(mState[1] * 5u, 7) * 9u;
+    uint64 shifted = mState[1] << 17u;
+
+    mState[2] ^= mState[0];
+    mState[3] ^= mState[1];
+    mState[1] ^= mState[2];
+    mState[0] ^= mState[3];
+    mState[2] ^= shifted;
+    mState[3] = std::rotl(mState[3], 45);
+
+    return result;
+  }
+
+  /* Same as 2^128 calls, so jumping n times starts the n-th of 2^128 streams
+   * that never overlap. */
+  constexpr void Jump() {
+    std::array<uint64, 4u> state{};
+    for (auto word : kJump) {
+      for (std::size_t bit = 0u; bit < 64u; ++bit) {
+        if (word & (1ull << bit)) {
+          for (std::size_t i = 0u; i < state.size(); ++i) {
+            state[i] ^= mState[i];
+          }
+        }
+        (*this)();
+      }
+    }
+    mState = state;
+  }
+
+  bool operator==(Xoshiro256 const& aOther) const = default;
+
+ private:
+  static std::array<uint64, 4u> constexpr kJump{
+      0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull,
+      0x39ABDC4529B1661Cull};
+
+  std::array<uint64, 4u> mState{};
+};
+
+/* Any 64 bit UniformRandomBitGenerator can stand in here. */
+using Generator = Xoshiro256;
+
+static_assert(Generator::min() == 0u &&
+              Generator::max() == std::numeric_limits<uint64>::max());
+
+/* Seeded from the system. */
 static Generator MakeGenerator() {
   std::random_device randomDevice{};
-  Generator generator{randomDevice()};
+  Generator generator{(uint64{randomDevice()} << 32u) | randomDevice()};
   return generator;
 }
 
-template <class T, class GetWeight>
-T WeightedSample(std::vector<T> const& aData, GetWeight&& aGetWeight,
-                 Generator& aGenerator) {
-  ASSERT(aData.size() > 0);
+/* Stream aStream of the generator seeded with aSeed, one per thread. */
+static Generator MakeGenerator(uint64 aSeed, std::size_t aStream) {
+  Generator generator{aSeed};
+  for (std::size_t i = 0u; i < aStream; ++i) {
+    generator.Jump();
+  }
+  return generator;
+}
+
+/* Uniform in [0, aBound) without the bias of a modulo: the high half of the
+ * 128 bit product of a number and aBound, redrawn while the low half lands
+ * in the 2^64 mod aBound values that would favour small results (Lemire). */
+inline std::size_t Uniform(Generator& aGenerator, std::size_t aBound) {
+  ASSERT(aBound > 0u);
+
+  using Product = unsigned __int128;
+  Product product = static_cast<Product>(aGenerator()) * aBound;
+  if (static_cast<uint64>(product) < aBound) {
+    uint64 threshold = -static_cast<uint64>(aBound) % aBound;
+    while (static_cast<uint64>(product) < threshold) {
+      product = static_cast<Product>(aGenerator()) * aBound;
+    }
+  }
+  return static_cast<std::size_t>(product >> 64u);
+}
 
-  std::vector<std::size_t> weights{};
-  weights.resize(aData.size());
+/* Weights are evaluated twice instead of being stored, so sampling never
+ * touches the heap. */
+template <class Container, class GetWeight>
+auto WeightedSample(Container const& aData, GetWeight&& aGetWeight,
+                    Generator& aGenerator) {
+  ASSERT(aData.size() > 0);
 
   std::size_t allWeight{0u};
-  for (std::size_t i = 0u; i < weights.size(); ++i) {
-    weights[i] = aGetWeight(i);
-    allWeight += weights[i];
+  for (std::size_t i = 0u; i < aData.size(); ++i) {
+    allWeight += aGetWeight(i);
   }
 
   ASSERT(allWeight > 0u);
 
-  std::size_t sample = aGenerator() % allWeight;
-  for (std::size_t i = 0u; i < weights.size(); ++i) {
-    if (sample < weights[i]) {
+  std::size_t sample = Uniform(aGenerator, allWeight);
+  for (std::size_t i = 0u; i < aData.size(); ++i) {
+    std::size_t weight = aGetWeight(i);
+    if (sample < weight) {
       return aData[i];
     }
 
-    sample -= weights[i];
+    sample -= weight;
   }
 
   ASSERT_ALWAYS();
@@ -0,0 +1,144 @@
+#ifndef UTIL_POOL_HPP
+#define UTIL_POOL_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include "util_General.hpp"
+
+namespace util {
+
+/**
+ * Bump allocator for records addressed by index, stored as one column per
+ * field type: Get<I>(index) is field I of a record, and within a chunk each
+ * column is a contiguous array, so a loop over one field of neighbouring
+ * records reads nothing else. Storage grows in fixed size chunks that never
+ * move, so indices and references stay valid until Reset. Reset drops every
+ * record at once and keeps the chunks for reuse, records are never destroyed
+ * so no field may own resources. Allocation is thread safe.
+ */
+template <class... Ts>
+class Pool {
+ public:
+  static std::size_t constexpr kChunkBits = 12u;
+  static std::size_t constexpr kMaxChunkCount = 1u << 14u;
+  static std::size_t constexpr kChunkSize = 1ul << kChunkBits;
+  static std::size_t constexpr kCapacity = kChunkSize * kMaxChunkCount;
+  /* Bytes of one record over all columns. */
+  static std::size_t constexpr kRecordSize = (sizeof(Ts) + ...);
+
+  template <std::size_t aColumn>
+  using Column = std::tuple_element_t<aColumn, std::tuple<Ts...>>;
+
+  Pool() = default;
+  Pool(Pool const&) = delete;
+  Pool& operator=(Pool const&) = delete;
+
+  ~Pool() {
+    for (auto& chunk : mChunks) {
+      ::operator delete(chunk.load(), std::align_val_t{kChunkAlignment});
+    }
+  }
+
+  /* Every field starts as T{}. */
+  uint32 Allocate() { return AllocateRange(1u); }
+
+  /* aCount neighbouring records, all in one chunk. */
+  uint32 AllocateRange(std::size_t aCount) {
+    ASSERT(aCount > 0u && aCount <= kChunkSize);
+
+    std::size_t begin = mSize.load(std::memory_order_relaxed);
+    std::size_t first;
+    do {
+      first = begin;
+      if ((first & kIndexMask) + aCount > kChunkSize) {
+        first = (first | kIndexMask) + 1u;
+      }
+    } while (!mSize.compare_exchange_weak(begin, first + aCount,
+                                          std::memory_order_relaxed));
+    ASSERT(first + aCount <= kCapacity);
+
+    std::byte* chunk = GetChunk(first >> kChunkBits);
+    for (std::size_t i = first; i < first + aCount; ++i) {
+      Construct(chunk, i & kIndexMask, std::index_sequence_for<Ts...>{});
+    }
+    return static_cast<uint32>(first);
+  }
+
+  template <std::size_t aColumn>
+  Column<aColumn>& Get(uint32 aIndex) {
+    return *GetField<aColumn>(aIndex);
+  }
+  template <std::size_t aColumn>
+  Column<aColumn> const& Get(uint32 aIndex) const {
+    return *GetField<aColumn>(aIndex);
+  }
+
+  /* Indices handed out so far, including any skipped at the end of a chunk
+   * by AllocateRange. */
+  std::size_t GetSize() const { return mSize.load(std::memory_order_relaxed); }
+
+  void Reset() { mSize.store(0u, std::memory_order_relaxed); }
+
+ private:
+  static std::size_t constexpr kIndexMask = kChunkSize - 1u;
+  static std::size_t constexpr kChunkAlignment = std::max({alignof(Ts)...});
+
+  /* Byte offset of each column in a chunk. */
+  static constexpr std::array<std::size_t, sizeof...(Ts)> kOffsets = [] {
+    std::array<std::size_t, sizeof...(Ts)> offsets{};
+    std::size_t offset{0u};
+    std::size_t column{0u};
+    ((offset = (offset + alignof(Ts) - 1u) / alignof(Ts) * alignof(Ts),
+      offsets[column++] = offset, offset += sizeof(Ts) * kChunkSize),
+     ...);
+    return offsets;
+  }();
+  static std::size_t constexpr kChunkBytes =
+      kOffsets.back() + sizeof(Column<sizeof...(Ts) - 1u>) * kChunkSize;
+
+  template <std::size_t... aColumns>
+  static void Construct(std::byte* aChunk, std::size_t aIndex,
+                        std::index_sequence<aColumns...>) {
+    (new (aChunk + kOffsets[aColumns] + aIndex * sizeof(Ts)) Ts{}, ...);
+  }
+
+  template <std::size_t aColumn>
+  Column<aColumn>* GetField(uint32 aIndex) const {
+    ASSERT(aIndex < GetSize());
+    std::byte* chunk =
+        mChunks[aIndex >> kChunkBits].load(std::memory_order_relaxed);
+    std::size_t offset = kOffsets[aColumn] +
+                         (aIndex & kIndexMask) * sizeof(Column<aColumn>);
+    return std::launder(reinterpret_cast<Column<aColumn>*>(chunk + offset));
+  }
+
+  std::byte* GetChunk(std::size_t aChunk) {
+    std::byte* chunk = mChunks[aChunk].load(std::memory_order_acquire);
+    if (chunk) {
+      return chunk;
+    }
+
+    std::lock_guard<std::mutex> lock{mMutex};
+    chunk = mChunks[aChunk].load(std::memory_order_relaxed);
+    if (!chunk) {
+      chunk = static_cast<std::byte*>(
+          ::operator new(kChunkBytes, std::align_val_t{kChunkAlignment}));
+      mChunks[aChunk].store(chunk, std::memory_order_release);
+    }
+    return chunk;
+  }
+
+  std::array<std::atomic<std::byte*>, kMaxChunkCount> mChunks{};
+  std::atomic<std::size_t> mSize{0u};
+  std::mutex mMutex{};
+};
+
+}  // namespace util
+
+#endif  // UTIL_POOL_HPP
@@ -0,0 +1,75 @@
+#include "util_ThreadPool.hpp"
+
+namespace util {
+
+/* Throws std::system_error when a thread cannot be started, after stopping
+ * those that were. */
+ThreadPool::ThreadPool(std::size_t aThreadCount) {
+  ASSERT(aThreadCount > 0u);
+
+  mThreads.reserve(aThreadCount);
+  try {
+    for (std::size_t i = 0u; i < aThreadCount; ++i) {
+      mThreads.emplace_back([this, i] { RunThread(i); });
+    }
+  } catch (...) {
+    Stop();
+    throw;
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  Wait();
+  Stop();
+}
+
+void ThreadPool::Start(Job const& aJob) {
+  std::lock_guard<std::mutex> lock{mMutex};
+  ASSERT(mRunningCount == 0u);
+  mJob = aJob;
+  mGeneration++;
+  mRunningCount = mThreads.size();
+  mStarted.notify_all();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock{mMutex};
+  mFinished.wait(lock, [this] { return mRunningCount == 0u; });
+}
+
+void ThreadPool::Stop() {
+  {
+    std::lock_guard<std::mutex> lock{mMutex};
+    mStop = true;
+    mStarted.notify_all();
+  }
+
+  for (auto& thread : mThreads) {
+    thread.join();
+  }
+}
+
+void ThreadPool::RunThread(std::size_t aIndex) {
+  std::size_t generation{0u};
+
+  std::unique_lock<std::mutex> lock{mMutex};
+  while (true) {
+    mStarted.wait(lock, [&] { return mStop || generation != mGeneration; });
+    if (mStop) {
+      break;
+    }
+
+    generation = mGeneration;
+    lock.unlock();
+
+    mJob(aIndex);
+
+    lock.lock();
+    mRunningCount--;
+    if (mRunningCount == 0u) {
+      mFinished.notify_all();
+    }
+  }
+}
+
+}  // namespace util
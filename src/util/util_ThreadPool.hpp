@@ -0,0 +1,77 @@
+#ifndef UTIL_THREADPOOL_HPP
+#define UTIL_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util_General.hpp"
+
+namespace util {
+
+/**
+ * A fixed set of worker threads that all run the same job. Each thread calls
+ * the job once with its own index, so callers can keep per-thread state in an
+ * array indexed by that value.
+ */
+class ThreadPool {
+ public:
+  using Job = std::function<void(std::size_t aThreadIndex)>;
+
+  ThreadPool(std::size_t aThreadCount);
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  std::size_t GetThreadCount() const { return mThreads.size(); }
+
+  /* Hand the job to every thread and return immediately. */
+  void Start(Job const& aJob);
+  /* Block until every thread has finished the last started job. */
+  void Wait();
+  void Run(Job const& aJob) {
+    Start(aJob);
+    Wait();
+  }
+
+ private:
+  /* Joins the threads once their job is done. */
+  void Stop();
+  void RunThread(std::size_t aIndex);
+
+  std::vector<std::thread> mThreads{};
+  std::mutex mMutex{};
+  std::condition_variable mStarted{};
+  std::condition_variable mFinished{};
+  Job mJob{};
+  std::size_t mGeneration{0u};
+  std::size_t mRunningCount{0u};
+  bool mStop{false};
+};
+
+/* A one byte lock for data that is held briefly and rarely contended, such
+ * as a node of a shared search tree. Waiters yield rather than spin hot, the
+ * holder may share a core with them. Works with std::lock_guard. */
+class SpinLock {
+ public:
+  void lock() {
+    while (mLocked.exchange(true, std::memory_order_acquire)) {
+      while (mLocked.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void unlock() { mLocked.store(false, std::memory_order_release); }
+
+ private:
+  std::atomic<bool> mLocked{false};
+};
+
+}  // namespace util
+
+#endif  // UTIL_THREADPOOL_HPP